@@ -0,0 +1,200 @@
+#ifndef COMT_COMTSMALLVECTOR_H
+#define COMT_COMTSMALLVECTOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "COMTConfig.h"
+
+namespace comt
+{
+	//----------------------------------------------------------------
+	// Class - SmallVector
+	//----------------------------------------------------------------
+	// A vector which stores up to N elements inside the object itself
+	// and only allocates memory once it grows beyond that. Intended
+	// for the many short lists which would otherwise each require a
+	// separate allocation. Once allocated, the memory is kept until
+	// the vector is destroyed, just like a std::vector it does not
+	// shrink when cleared. The elements are moved around as plain
+	// memory, hence only trivially copyable types can be stored.
+	// Iterators are plain pointers and are invalidated by any
+	// operation which increases the size beyond the capacity.
+	//----------------------------------------------------------------
+	template <class T, unsigned int N> class SmallVector
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "small vectors only store trivially copyable types");
+		static_assert(N > 0, "small vectors should hold at least one element inline");
+
+	public:
+		typedef T value_type;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		//(copy) constructors, assignment and destructor
+		SmallVector()
+			: m_pData(GetInline())
+			, m_nSize(0)
+			, m_nCapacity(N)
+		{
+		}
+
+		SmallVector(const SmallVector &val)
+			: m_pData(GetInline())
+			, m_nSize(0)
+			, m_nCapacity(N)
+		{
+			*this = val;
+		}
+
+		SmallVector(SmallVector &&val)
+			: m_pData(GetInline())
+			, m_nSize(0)
+			, m_nCapacity(N)
+		{
+			//allocated memory is taken over, inline elements have to be copied
+			if (!val.IsInline()) {
+				m_pData = val.m_pData;
+				m_nCapacity = val.m_nCapacity;
+				val.m_pData = val.GetInline();
+				val.m_nCapacity = N;
+			} else if (val.m_nSize > 0) {
+				memcpy(m_pData, val.m_pData, val.m_nSize * sizeof(T));
+			}
+
+			m_nSize = val.m_nSize;
+			val.m_nSize = 0;
+		}
+
+		void operator = (const SmallVector &val)
+		{
+			if (this == &val) {
+				return;
+			}
+
+			Reserve(val.m_nSize);
+
+			if (val.m_nSize > 0) {
+				memcpy(m_pData, val.m_pData, val.m_nSize * sizeof(T));
+			}
+
+			m_nSize = val.m_nSize;
+		}
+
+		~SmallVector()
+		{
+			if (!IsInline()) {
+				::operator delete(m_pData);
+			}
+		}
+
+		//retrieving size information
+		unsigned int size() const { return m_nSize; }
+		unsigned int capacity() const { return m_nCapacity; }
+		bool empty() const { return m_nSize == 0; }
+		bool IsInline() const { return m_pData == GetInline(); }
+
+		//accessing the elements
+		T* data() { return m_pData; }
+		const T* data() const { return m_pData; }
+		iterator begin() { return m_pData; }
+		iterator end() { return m_pData + m_nSize; }
+		const_iterator begin() const { return m_pData; }
+		const_iterator end() const { return m_pData + m_nSize; }
+		const_iterator cbegin() const { return m_pData; }
+		const_iterator cend() const { return m_pData + m_nSize; }
+
+		T& operator [] (const unsigned int nIndex) { assert(nIndex < m_nSize); return m_pData[nIndex]; }
+		const T& operator [] (const unsigned int nIndex) const { assert(nIndex < m_nSize); return m_pData[nIndex]; }
+		T& front() { assert(m_nSize > 0); return m_pData[0]; }
+		const T& front() const { assert(m_nSize > 0); return m_pData[0]; }
+		T& back() { assert(m_nSize > 0); return m_pData[m_nSize - 1]; }
+		const T& back() const { assert(m_nSize > 0); return m_pData[m_nSize - 1]; }
+
+		//modifying the elements
+		void push_back(const T &value)
+		{
+			//the value may be an element of this vector, which moves when growing
+			const T copy = value;
+
+			if (m_nSize == m_nCapacity) {
+				Grow(m_nSize + 1);
+			}
+
+			m_pData[m_nSize++] = copy;
+		}
+
+		void pop_back()
+		{
+			assert(m_nSize > 0);
+			m_nSize--;
+		}
+
+		void clear()
+		{
+			m_nSize = 0;
+		}
+
+		void resize(const unsigned int nSize)
+		{
+			resize(nSize, T());
+		}
+
+		void resize(const unsigned int nSize, const T &value)
+		{
+			const T copy = value;
+			Reserve(nSize);
+
+			for (unsigned int i = m_nSize; i < nSize; i++) {
+				m_pData[i] = copy;
+			}
+
+			m_nSize = nSize;
+		}
+
+		void reserve(const unsigned int nCapacity)
+		{
+			Reserve(nCapacity);
+		}
+
+	private:
+		//the elements, either stored inline or in allocated memory
+		typename std::aligned_storage<sizeof(T) * N, std::alignment_of<T>::value>::type m_inline;
+		T							*m_pData;
+		unsigned int				m_nSize;
+		unsigned int				m_nCapacity;
+
+		T* GetInline() { return reinterpret_cast<T*>(&m_inline); }
+		const T* GetInline() const { return reinterpret_cast<const T*>(&m_inline); }
+
+		void Reserve(const unsigned int nCapacity)
+		{
+			if (nCapacity > m_nCapacity) {
+				Grow(nCapacity);
+			}
+		}
+
+		void Grow(const unsigned int nMinimum)
+		{
+			//at least double the capacity, such that adding elements takes amortized constant time
+			const unsigned int nCapacity = nMinimum > m_nCapacity * 2 ? nMinimum : m_nCapacity * 2;
+			T* const pData = static_cast<T*>(::operator new(nCapacity * sizeof(T)));
+
+			if (m_nSize > 0) {
+				memcpy(pData, m_pData, m_nSize * sizeof(T));
+			}
+
+			if (!IsInline()) {
+				::operator delete(m_pData);
+			}
+
+			m_pData = pData;
+			m_nCapacity = nCapacity;
+		}
+	};
+}
+
+#endif
\ No newline at end of file
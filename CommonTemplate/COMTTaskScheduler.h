@@ -0,0 +1,279 @@
+#ifndef COMT_COMTTASKSCHEDULER_H
+#define COMT_COMTTASKSCHEDULER_H
+
+#include <cassert>
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "COMTConfig.h"
+
+namespace comt
+{
+	//----------------------------------------------------------------
+	// Class - TaskScheduler
+	//----------------------------------------------------------------
+	// A persistent set of worker threads processing small tasks using
+	// work stealing. A task is an item together with the stage of the
+	// item which should be processed, and may spawn further tasks, for
+	// example the next stage of the same item. Every thread owns a
+	// deque of tasks: the thread itself pushes and pops tasks at the
+	// front, such that a spawned task is usually processed right away
+	// by the thread which spawned it, while idle threads steal the
+	// oldest tasks from the back of the deques of other threads. The
+	// items are initially divided into contiguous blocks, one block
+	// per thread, after which stealing balances the work when some
+	// tasks take much longer than others. The calling thread takes
+	// part in the work as thread 0, the worker threads are threads 1
+	// up to GetNumThreads() - 1. The function passed to Run(...)
+	// should not throw and should not call Run(...) itself. The
+	// deques keep their memory in between calls.
+	//----------------------------------------------------------------
+	class TaskScheduler
+	{
+	public:
+		struct Task
+		{
+			unsigned int			nItem;
+			unsigned int			nStage;
+		};
+
+		typedef std::function<void (const Task &task, const unsigned int iThread)> FUNCTION_TASK;
+
+		//constructors and destructor
+		TaskScheduler()
+			: m_pFunction(NULL)
+			, m_nPending(0)
+			, m_nBusy(0)
+			, m_nGeneration(0)
+			, m_bStop(false)
+		{
+			Start(std::thread::hardware_concurrency());
+		}
+
+		explicit TaskScheduler(const unsigned int nThreads)
+			: m_pFunction(NULL)
+			, m_nPending(0)
+			, m_nBusy(0)
+			, m_nGeneration(0)
+			, m_bStop(false)
+		{
+			Start(nThreads);
+		}
+
+		~TaskScheduler()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_bStop = true;
+			}
+
+			m_cvStart.notify_all();
+
+			for (auto &thread : m_veThreads) {
+				thread.join();
+			}
+		}
+
+		//retrieving the number of threads, including the calling thread
+		unsigned int GetNumThreads() const
+		{
+			return m_veThreads.size() + 1;
+		}
+
+		//processing stage 0 of all items in [0, nItems), and all tasks spawned while doing so.
+		//Returns once no tasks remain
+		void Run(const unsigned int nItems, const FUNCTION_TASK &function)
+		{
+			if (nItems == 0) {
+				return;
+			}
+
+			{
+				//every thread starts with a contiguous block of items, pushed in reverse such that
+				//the thread processes its items in increasing order
+				std::lock_guard<std::mutex> lock(m_mutex);
+				const unsigned int nThreads = GetNumThreads();
+
+				for (unsigned int i = 0; i < nThreads; i++) {
+					const unsigned int nFirst = (unsigned int)((unsigned long long)nItems * i / nThreads);
+					const unsigned int nLast = (unsigned int)((unsigned long long)nItems * (i + 1) / nThreads);
+
+					for (unsigned int j = nLast; j > nFirst; j--) {
+						const Task task = { j - 1, 0 };
+						m_veQueues[i].veTasks.push_back(task);
+					}
+				}
+
+				m_pFunction = &function;
+				m_nPending.store(nItems);
+				m_nBusy = m_veThreads.size();
+				m_nGeneration++;
+			}
+
+			if (!m_veThreads.empty()) {
+				m_cvStart.notify_all();
+			}
+
+			Execute(0);
+
+			//wait for the worker threads to finish their last tasks
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvDone.wait(lock, [this] { return m_nBusy == 0; });
+			m_pFunction = NULL;
+		}
+
+		//adding a task to the front of the deque of the calling thread, only valid from within the
+		//function passed to Run(...)
+		void Spawn(const Task &task, const unsigned int iThread)
+		{
+			assert(iThread < m_veQueues.size());
+
+			//the task is pending before the task spawning it completes, hence the number of pending
+			//tasks does not reach zero in between
+			m_nPending.fetch_add(1);
+			Queue &queue = m_veQueues[iThread];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.veTasks.push_back(task);
+		}
+
+	private:
+		//the deque of a single thread. The tasks in [nBack, veTasks.size()) are queued, the front
+		//is at the end of the vector
+		struct Queue
+		{
+			Queue() : nBack(0) {}
+
+			std::mutex				mutex;
+			std::vector<Task>		veTasks;
+			unsigned int			nBack;
+		};
+
+		//the worker threads and the deque of every thread
+		std::vector<std::thread>	m_veThreads;
+		std::vector<Queue>			m_veQueues;
+
+		//the work currently being processed
+		const FUNCTION_TASK			*m_pFunction;
+		std::atomic<unsigned int>	m_nPending;
+
+		//synchronization between the calling thread and the worker threads
+		std::mutex					m_mutex;
+		std::condition_variable		m_cvStart;
+		std::condition_variable		m_cvDone;
+		unsigned int				m_nBusy;
+		unsigned long long			m_nGeneration;
+		bool						m_bStop;
+
+		TaskScheduler(const TaskScheduler &);
+		void operator = (const TaskScheduler &);
+
+		void Start(const unsigned int nThreads)
+		{
+			//the calling thread is one of the threads
+			const unsigned int nTotal = nThreads > 0 ? nThreads : 1;
+			std::vector<Queue>(nTotal).swap(m_veQueues);
+
+			for (unsigned int i = 1; i < nTotal; i++) {
+				m_veThreads.push_back(std::thread(&TaskScheduler::Work, this, i));
+			}
+		}
+
+		bool Pop(const unsigned int iThread, Task &task)
+		{
+			Queue &queue = m_veQueues[iThread];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+
+			if (queue.veTasks.size() == queue.nBack) {
+				return false;
+			}
+
+			task = queue.veTasks.back();
+			queue.veTasks.pop_back();
+			Reset(queue);
+			return true;
+		}
+
+		bool Steal(const unsigned int iThread, Task &task)
+		{
+			//the other threads are visited starting at the next thread, such that the thieves do
+			//not all start at the same victim
+			const unsigned int nThreads = m_veQueues.size();
+
+			for (unsigned int i = 1; i < nThreads; i++) {
+				Queue &queue = m_veQueues[(iThread + i) % nThreads];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+
+				if (queue.veTasks.size() == queue.nBack) {
+					continue;
+				}
+
+				task = queue.veTasks[queue.nBack++];
+				Reset(queue);
+				return true;
+			}
+
+			return false;
+		}
+
+		static void Reset(Queue &queue)
+		{
+			//an empty deque starts at the beginning of its memory again
+			if (queue.veTasks.size() == queue.nBack) {
+				queue.veTasks.clear();
+				queue.nBack = 0;
+			}
+		}
+
+		void Execute(const unsigned int iThread)
+		{
+			//keep processing tasks until no task is pending anymore. Tasks that are pending but not
+			//queued are being processed by other threads and may still spawn new tasks
+			Task task;
+
+			while (m_nPending.load() > 0) {
+				if (Pop(iThread, task) || Steal(iThread, task)) {
+					(*m_pFunction)(task, iThread);
+					m_nPending.fetch_sub(1);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		void Work(const unsigned int iThread)
+		{
+			unsigned long long nGeneration = 0;
+
+			for (;;) {
+				{
+					//wait until new work is available or the scheduler is destroyed
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cvStart.wait(lock, [this, nGeneration] { return m_bStop || m_nGeneration != nGeneration; });
+
+					if (m_bStop) {
+						return;
+					}
+
+					nGeneration = m_nGeneration;
+				}
+
+				Execute(iThread);
+
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+
+					if (--m_nBusy == 0) {
+						m_cvDone.notify_one();
+					}
+				}
+			}
+		}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,416 @@
+#include "FENNBrain.h"
+#include "FENNBrainKernels.h"
+#include "FENNRNA.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+	//markers used while determining the topological order of the neurons
+	const unsigned int POSITION_UNVISITED = ~0u;
+	const unsigned int POSITION_VISITING = ~0u - 1;
+
+	inline VALUE_TYPE EvaluateInstruction(const fenn::BrainInstruction &instruction, const fenn::BrainOperand * const pOperands, const VALUE_TYPE * const pActivations)
+	{
+		const fenn::BrainOperand *pOperand = pOperands + instruction.nFirstOperand;
+		const fenn::BrainOperand * const pSlot = pOperands + instruction.nSlotOperand;
+		const fenn::BrainOperand * const pLast = pOperands + instruction.nLastOperand;
+
+		//neurons without incoming connections only output their bias
+		if (pOperand == pLast) {
+			return instruction.fBias;
+		}
+
+		switch (instruction.eNeuronType) {
+		case fenn::NEURONTYPE_ADDITION: {
+			VALUE_TYPE fSum = 0;
+
+			for (; pOperand != pLast; ++pOperand) {
+				fSum += pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			return instruction.fBias + fSum;
+		}
+		case fenn::NEURONTYPE_SUBTRACTION: {
+			VALUE_TYPE fSum = 0;
+
+			for (; pOperand != pSlot; ++pOperand) {
+				fSum += pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			for (; pOperand != pLast; ++pOperand) {
+				fSum -= pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			return instruction.fBias + fSum;
+		}
+		case fenn::NEURONTYPE_MULTIPLICATION: {
+			VALUE_TYPE fProduct = 1;
+
+			for (; pOperand != pLast; ++pOperand) {
+				fProduct *= pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			return instruction.fBias + fProduct;
+		}
+		case fenn::NEURONTYPE_DIVISION: {
+			VALUE_TYPE fNumerator = 1;
+			VALUE_TYPE fDenominator = 1;
+
+			for (; pOperand != pSlot; ++pOperand) {
+				fNumerator *= pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			for (; pOperand != pLast; ++pOperand) {
+				fDenominator *= pOperand->fWeight * pActivations[pOperand->nSource];
+			}
+
+			return instruction.fBias + (fDenominator != 0 ? fNumerator / fDenominator : 0);
+		}
+		default:
+			//unknown neuron types should never be compiled
+			assert(false);
+			return instruction.fBias;
+		}
+	}
+
+	void EvaluateInstructionTile(const fenn::BrainInstruction &instruction, const fenn::BrainOperand * const pOperands, VALUE_TYPE * const pActivations, 
+		VALUE_TYPE * const pTarget, VALUE_TYPE * const pTemporary, const unsigned int nCount, const fenn::BrainKernels &kernels)
+	{
+		//This function evaluates a single instruction for a tile of samples. Every activation is
+		//a row of BRAIN_TILE_SIZE values. The operations are performed in the same order as in
+		//EvaluateInstruction(...) to obtain exactly the same results
+		const fenn::BrainOperand *pOperand = pOperands + instruction.nFirstOperand;
+		const fenn::BrainOperand * const pSlot = pOperands + instruction.nSlotOperand;
+		const fenn::BrainOperand * const pLast = pOperands + instruction.nLastOperand;
+
+		if (pOperand == pLast) {
+			kernels.Fill(pTarget, instruction.fBias, nCount);
+			return;
+		}
+
+		switch (instruction.eNeuronType) {
+		case fenn::NEURONTYPE_ADDITION:
+			kernels.Fill(pTarget, 0, nCount);
+
+			for (; pOperand != pLast; ++pOperand) {
+				kernels.AddWeighted(pTarget, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			break;
+		case fenn::NEURONTYPE_SUBTRACTION:
+			kernels.Fill(pTarget, 0, nCount);
+
+			for (; pOperand != pSlot; ++pOperand) {
+				kernels.AddWeighted(pTarget, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			for (; pOperand != pLast; ++pOperand) {
+				kernels.SubtractWeighted(pTarget, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			break;
+		case fenn::NEURONTYPE_MULTIPLICATION:
+			kernels.Fill(pTarget, 1, nCount);
+
+			for (; pOperand != pLast; ++pOperand) {
+				kernels.MultiplyWeighted(pTarget, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			break;
+		case fenn::NEURONTYPE_DIVISION: {
+			//the numerator is computed in the target row, the denominator in the temporary row
+			kernels.Fill(pTarget, 1, nCount);
+			kernels.Fill(pTemporary, 1, nCount);
+
+			for (; pOperand != pSlot; ++pOperand) {
+				kernels.MultiplyWeighted(pTarget, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			for (; pOperand != pLast; ++pOperand) {
+				kernels.MultiplyWeighted(pTemporary, pActivations + pOperand->nSource * BRAIN_TILE_SIZE, pOperand->fWeight, nCount);
+			}
+
+			kernels.Divide(pTarget, pTarget, pTemporary, nCount);
+			break;
+		}
+		default:
+			assert(false);
+			kernels.Fill(pTarget, 0, nCount);
+			break;
+		}
+
+		kernels.Add(pTarget, instruction.fBias, nCount);
+	}
+}
+
+fenn::Brain::Brain()
+	: m_nNumInputs(0)
+{
+}
+
+fenn::Brain::Brain(const RNA &rna)
+	: m_nNumInputs(0)
+{
+	Compile(rna);
+}
+
+fenn::Brain::Brain(const Brain &brain)
+	: m_nNumInputs(brain.m_nNumInputs)
+	, m_veInstructions(brain.m_veInstructions)
+	, m_veOperands(brain.m_veOperands)
+	, m_veOutputs(brain.m_veOutputs)
+	, m_veActivations(brain.m_veActivations.size())
+	, m_veBatchActivations(brain.m_veBatchActivations.size())
+{
+}
+
+void fenn::Brain::operator = (const Brain &brain)
+{
+	//only copy the compiled program, the compilation buffers are not needed
+	m_nNumInputs		= brain.m_nNumInputs;
+	m_veInstructions	= brain.m_veInstructions;
+	m_veOperands		= brain.m_veOperands;
+	m_veOutputs			= brain.m_veOutputs;
+	m_veActivations.resize(brain.m_veActivations.size());
+	m_veBatchActivations.resize(brain.m_veBatchActivations.size());
+}
+
+fenn::Brain::~Brain()
+{
+	//nothing to do
+}
+
+void fenn::Brain::Compile(const RNA &rna)
+{
+	//All buffers are cleared instead of released, such that recompiling a brain of a similar
+	//size does not require any allocations
+	Clear();
+
+	//the neurons are identified by their local index within the RNA: first the input neurons,
+	//then the output neurons and finally the hidden neurons
+	const unsigned int nNumNeurons = rna.GetNumNeurons();
+	m_nNumInputs = rna.GetNumInputNeurons();
+
+	//count the number of incoming connections of every neuron, the connection alleles are
+	//stored with the neuron they originate from, the brain needs them on the neuron they
+	//connect to
+	m_veIncomingStart.assign(nNumNeurons + 1, 0);
+	m_veIncomingSlot.assign(nNumNeurons, 0);
+
+	for (unsigned int iSource = 0; iSource < nNumNeurons; iSource++) {
+		const NeuronAllele &neuron = rna.GetNeuron(iSource);
+		const ConnectionAllele* const pConnections = rna.GetConnections(neuron);
+
+		for (unsigned int i = 0; i < neuron.nNumConnections; i++) {
+			const unsigned int nTarget = pConnections[i].nConnectedNeuron;
+			m_veIncomingStart[nTarget + 1]++;
+
+			if (pConnections[i].nConnectedSlot == 0) {
+				m_veIncomingSlot[nTarget]++;
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < nNumNeurons; i++) {
+		m_veIncomingStart[i + 1] += m_veIncomingStart[i];
+		m_veIncomingSlot[i] += m_veIncomingStart[i];
+	}
+
+	//place all incoming connections, such that the connections to slot 0 come first. The
+	//source of an operand temporarily holds the position of the connected neuron. The stack
+	//and activation index buffers are not needed yet and serve as the placement cursors
+	m_veIncoming.resize(m_veIncomingStart[nNumNeurons]);
+	m_veStack.assign(m_veIncomingStart.cbegin(), m_veIncomingStart.cend() - 1);
+	m_veActivationIndex.assign(m_veIncomingSlot.cbegin(), m_veIncomingSlot.cend());
+
+	for (unsigned int iSource = 0; iSource < nNumNeurons; iSource++) {
+		const NeuronAllele &neuron = rna.GetNeuron(iSource);
+		const ConnectionAllele* const pConnections = rna.GetConnections(neuron);
+		const WEIGHT_TYPE* const pWeights = rna.GetWeights(neuron);
+
+		for (unsigned int i = 0; i < neuron.nNumConnections; i++) {
+			const unsigned int nTarget = pConnections[i].nConnectedNeuron;
+			unsigned int &nCursor = pConnections[i].nConnectedSlot == 0 ? m_veStack[nTarget] : m_veActivationIndex[nTarget];
+
+			BrainOperand &operand = m_veIncoming[nCursor++];
+			operand.nSource = iSource;
+			operand.fWeight = pWeights[i];
+		}
+	}
+
+	//determine the topological order by a depth-first search from the output neurons along
+	//the incoming connections, every neuron is added after all neurons connected to it. This
+	//automatically leaves out all neurons that do not contribute to any output
+	m_veActivationIndex.assign(nNumNeurons, POSITION_UNVISITED);
+	m_veStack.clear();
+
+	for (unsigned int i = 0; i < m_nNumInputs; i++) {
+		m_veActivationIndex[i] = i;
+	}
+
+	unsigned int nNextActivation = m_nNumInputs;
+
+	for (unsigned int iOutput = rna.GetFirstOutputNeuron(); iOutput < rna.GetFirstHiddenNeuron(); iOutput++) {
+		m_veStack.push_back(iOutput);
+
+		while (!m_veStack.empty()) {
+			const unsigned int nCurrent = m_veStack.back();
+			unsigned int &nActivation = m_veActivationIndex[nCurrent];
+
+			if (nActivation == POSITION_UNVISITED) {
+				//first visit, process all connected neurons before this one
+				nActivation = POSITION_VISITING;
+
+				for (unsigned int i = m_veIncomingStart[nCurrent]; i < m_veIncomingStart[nCurrent + 1]; i++) {
+					const unsigned int nSource = m_veIncoming[i].nSource;
+
+					//encountering a neuron which is still being visited means the RNA contains
+					//a value loop, which the mutation functions should never create
+					assert(m_veActivationIndex[nSource] != POSITION_VISITING);
+
+					if (m_veActivationIndex[nSource] == POSITION_UNVISITED) {
+						m_veStack.push_back(nSource);
+					}
+				}
+			} else {
+				//second visit, all connected neurons are processed. Create the instruction
+				if (nActivation == POSITION_VISITING) {
+					nActivation = nNextActivation++;
+
+					const NeuronAllele &neuron = rna.GetNeuron(nCurrent);
+					BrainInstruction instruction;
+					instruction.eNeuronType		= neuron.eNeuronType;
+					instruction.nFirstOperand	= m_veOperands.size();
+					instruction.nSlotOperand	= instruction.nFirstOperand + m_veIncomingSlot[nCurrent] - m_veIncomingStart[nCurrent];
+					instruction.nLastOperand	= instruction.nFirstOperand + m_veIncomingStart[nCurrent + 1] - m_veIncomingStart[nCurrent];
+					instruction.fBias			= rna.GetBiases()[nCurrent];
+
+					for (unsigned int i = m_veIncomingStart[nCurrent]; i < m_veIncomingStart[nCurrent + 1]; i++) {
+						BrainOperand operand;
+						operand.nSource = m_veActivationIndex[m_veIncoming[i].nSource];
+						operand.fWeight = m_veIncoming[i].fWeight;
+						m_veOperands.push_back(operand);
+					}
+
+					m_veInstructions.push_back(instruction);
+				}
+
+				m_veStack.pop_back();
+			}
+		}
+
+		m_veOutputs.push_back(m_veActivationIndex[iOutput]);
+	}
+
+	m_veActivations.resize(GetScratchSize());
+}
+
+void fenn::Brain::Clear()
+{
+	m_nNumInputs = 0;
+	m_veInstructions.clear();
+	m_veOperands.clear();
+	m_veOutputs.clear();
+	m_veIncoming.clear();
+	m_veStack.clear();
+}
+
+unsigned int fenn::Brain::GetNumInputs() const
+{
+	return m_nNumInputs;
+}
+
+unsigned int fenn::Brain::GetNumOutputs() const
+{
+	return m_veOutputs.size();
+}
+
+unsigned int fenn::Brain::GetNumInstructions() const
+{
+	return m_veInstructions.size();
+}
+
+unsigned int fenn::Brain::GetScratchSize() const
+{
+	return m_nNumInputs + m_veInstructions.size();
+}
+
+void fenn::Brain::Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput)
+{
+	assert(m_veActivations.size() >= GetScratchSize());
+	Evaluate(pInput, pOutput, m_veActivations.data());
+}
+
+void fenn::Brain::Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, VALUE_TYPE *pScratch) const
+{
+	//copy the input values to the start of the activation buffer
+	std::copy(pInput, pInput + m_nNumInputs, pScratch);
+
+	//evaluate all instructions in order, every instruction stores its value directly after
+	//the value of the previous instruction
+	const BrainOperand* const pOperands = m_veOperands.data();
+	VALUE_TYPE *pTarget = pScratch + m_nNumInputs;
+
+	for (const auto &instruction : m_veInstructions) {
+		*pTarget = EvaluateInstruction(instruction, pOperands, pScratch);
+		++pTarget;
+	}
+
+	//copy the values of the output neurons
+	const unsigned int nNumOutputs = m_veOutputs.size();
+
+	for (unsigned int i = 0; i < nNumOutputs; i++) {
+		pOutput[i] = pScratch[m_veOutputs[i]];
+	}
+}
+
+unsigned int fenn::Brain::GetBatchScratchSize() const
+{
+	//every activation is a row of a tile, with one additional row for the denominator of
+	//division neurons
+	return (GetScratchSize() + 1) * BRAIN_TILE_SIZE;
+}
+
+void fenn::Brain::EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples)
+{
+	//the batch buffer is only allocated when batches are actually evaluated
+	m_veBatchActivations.resize(GetBatchScratchSize());
+	EvaluateBatch(pInput, pOutput, nSamples, m_veBatchActivations.data(), GetBrainKernels());
+}
+
+void fenn::Brain::EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples, VALUE_TYPE *pScratch) const
+{
+	EvaluateBatch(pInput, pOutput, nSamples, pScratch, GetBrainKernels());
+}
+
+void fenn::Brain::EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples, VALUE_TYPE *pScratch, const BrainKernels &kernels) const
+{
+	const BrainOperand* const pOperands = m_veOperands.data();
+	const unsigned int nNumOutputs = m_veOutputs.size();
+	VALUE_TYPE* const pTemporary = pScratch + GetScratchSize() * BRAIN_TILE_SIZE;
+
+	for (unsigned int iStart = 0; iStart < nSamples; iStart += BRAIN_TILE_SIZE) {
+		const unsigned int nCount = nSamples - iStart < BRAIN_TILE_SIZE ? nSamples - iStart : BRAIN_TILE_SIZE;
+
+		//copy the input rows of this tile
+		for (unsigned int i = 0; i < m_nNumInputs; i++) {
+			memcpy(pScratch + i * BRAIN_TILE_SIZE, pInput + i * nSamples + iStart, nCount * sizeof(VALUE_TYPE));
+		}
+
+		//evaluate all instructions in order for the entire tile
+		VALUE_TYPE *pTarget = pScratch + m_nNumInputs * BRAIN_TILE_SIZE;
+
+		for (const auto &instruction : m_veInstructions) {
+			EvaluateInstructionTile(instruction, pOperands, pScratch, pTarget, pTemporary, nCount, kernels);
+			pTarget += BRAIN_TILE_SIZE;
+		}
+
+		//copy the output rows of this tile
+		for (unsigned int i = 0; i < nNumOutputs; i++) {
+			memcpy(pOutput + i * nSamples + iStart, pScratch + m_veOutputs[i] * BRAIN_TILE_SIZE, nCount * sizeof(VALUE_TYPE));
+		}
+	}
+}
\ No newline at end of file
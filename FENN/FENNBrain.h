@@ -0,0 +1,122 @@
+#ifndef FENN_BRAIN_H
+#define FENN_BRAIN_H
+
+#include "FENNConfig.h"
+#include "FENNNeuronBase.h"
+
+#include <vector>
+
+namespace fenn
+{
+	//forward definitions
+	class RNA;
+	struct BrainKernels;
+
+	//----------------------------------------------------------------
+	// Structure - BrainInstruction
+	//----------------------------------------------------------------
+	// A single neuron of a compiled brain. The value of the neuron is
+	// computed from the operands in the range [nFirstOperand,
+	// nLastOperand). Operands in [nFirstOperand, nSlotOperand) are
+	// connected to slot 0, the remaining operands to the other slots.
+	// The computed value is stored directly after the values of all
+	// previously evaluated instructions.
+	//----------------------------------------------------------------
+	struct BrainInstruction
+	{
+		NeuronType				eNeuronType;
+		unsigned int			nFirstOperand;
+		unsigned int			nSlotOperand;
+		unsigned int			nLastOperand;
+		BIAS_TYPE				fBias;
+	};
+
+	//----------------------------------------------------------------
+	// Structure - BrainOperand
+	//----------------------------------------------------------------
+	// A single weighted input of a compiled neuron. The source is the
+	// index of the value within the activation buffer of the brain.
+	//----------------------------------------------------------------
+	struct BrainOperand
+	{
+		unsigned int			nSource;
+		WEIGHT_TYPE				fWeight;
+	};
+
+	//----------------------------------------------------------------
+	// Class - Brain
+	//----------------------------------------------------------------
+	// The phenotype of a RNA string. Compiling a RNA string turns the
+	// graph of neuron alleles into a flat list of instructions in
+	// topological order, such that evaluating the brain is a single
+	// linear pass over a preallocated activation buffer. Neurons that
+	// do not (indirectly) connect to an output neuron are pruned.
+	// The activation buffer contains the input values, followed by
+	// the value of each instruction. The neuron types are evaluated
+	// as follows (with x the weighted inputs of a neuron):
+	//		- Addition: bias + sum(x)
+	//		- Subtraction: bias + sum(x in slot 0) - sum(x in slot 1)
+	//		- Multiplication: bias + product(x)
+	//		- Division: bias + product(x in slot 0) / product(x in
+	//			slot 1), where a zero denominator results in zero.
+	// A neuron without any incoming connections simply outputs its
+	// bias. Input neurons pass their input value unchanged.
+	//----------------------------------------------------------------
+	class Brain
+	{
+	public:
+		//(copy) constructors, assignment and destructor
+		Brain();
+		Brain(const RNA &rna);
+		Brain(const Brain &brain);
+		void operator = (const Brain &brain);
+		~Brain();
+
+		//compiling a RNA string into a brain
+		void Compile(const RNA &rna);
+		void Clear();
+
+		//retrieving size information
+		unsigned int GetNumInputs() const;
+		unsigned int GetNumOutputs() const;
+		unsigned int GetNumInstructions() const;
+		unsigned int GetScratchSize() const;
+
+		//evaluating the brain, either using the internal activation buffer or using a buffer
+		//provided by the caller (which should hold at least GetScratchSize() values). The
+		//latter can be used to evaluate the same brain from multiple threads simultaneously
+		void Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput);
+		void Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, VALUE_TYPE *pScratch) const;
+
+		//evaluating the brain for many samples at once. The samples are stored as structure-
+		//of-arrays: the input holds all nSamples values of the first input, followed by all
+		//values of the second input, etc. The output is stored in the same fashion. The samples
+		//are processed in tiles of BRAIN_TILE_SIZE using the best instruction set supported by
+		//the processor. The scratch buffer should hold at least GetBatchScratchSize() values
+		unsigned int GetBatchScratchSize() const;
+		void EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples);
+		void EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples, VALUE_TYPE *pScratch) const;
+		void EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples, VALUE_TYPE *pScratch, const BrainKernels &kernels) const;
+
+	protected:
+		//the compiled program
+		unsigned int				m_nNumInputs;
+		std::vector<BrainInstruction> m_veInstructions;
+		std::vector<BrainOperand>	m_veOperands;
+		std::vector<unsigned int>	m_veOutputs; //activation index of each output neuron
+
+		//preallocated activation buffers
+		std::vector<VALUE_TYPE>		m_veActivations;
+		std::vector<VALUE_TYPE>		m_veBatchActivations;
+
+	private:
+		//buffers only used while compiling, kept to reuse their capacity
+		std::vector<unsigned int>	m_veIncomingStart;
+		std::vector<BrainOperand>	m_veIncoming;
+		std::vector<unsigned int>	m_veIncomingSlot;
+		std::vector<unsigned int>	m_veActivationIndex;
+		std::vector<unsigned int>	m_veStack;
+	};
+}
+
+#endif
\ No newline at end of file
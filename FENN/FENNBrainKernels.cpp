@@ -0,0 +1,332 @@
+#include "FENNBrainKernels.h"
+
+#include <cassert>
+
+//determine whether the x86 kernels can be compiled. The intrinsics of a specific instruction
+//set may only be used by functions marked with the matching target, such that the rest of
+//the program does not require the instruction set
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define FENN_KERNELS_X86
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#include <immintrin.h>
+
+		#define FENN_TARGET_SSE
+		#define FENN_TARGET_AVX2
+	#else
+		#include <cpuid.h>
+		#include <immintrin.h>
+
+		#define FENN_TARGET_SSE __attribute__((target("sse2")))
+		#define FENN_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+namespace
+{
+	//----------------------------------------------------------------
+	// Scalar kernels
+	//----------------------------------------------------------------
+	void ScalarFill(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] = fValue;
+		}
+	}
+
+	void ScalarAdd(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] += fValue;
+		}
+	}
+
+	void ScalarAddWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] += fWeight * pSource[i];
+		}
+	}
+
+	void ScalarSubtractWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] -= fWeight * pSource[i];
+		}
+	}
+
+	void ScalarMultiplyWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] *= fWeight * pSource[i];
+		}
+	}
+
+	void ScalarDivide(VALUE_TYPE *pTarget, const VALUE_TYPE *pNumerator, const VALUE_TYPE *pDenominator, const unsigned int nCount)
+	{
+		for (unsigned int i = 0; i < nCount; i++) {
+			pTarget[i] = pDenominator[i] != 0 ? pNumerator[i] / pDenominator[i] : 0;
+		}
+	}
+
+#ifdef FENN_KERNELS_X86
+	//----------------------------------------------------------------
+	// SSE kernels (4 samples at once)
+	//----------------------------------------------------------------
+	FENN_TARGET_SSE void SSEFill(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		const __m128 value = _mm_set1_ps(fValue);
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			_mm_storeu_ps(pTarget + i, value);
+		}
+
+		ScalarFill(pTarget + i, fValue, nCount - i);
+	}
+
+	FENN_TARGET_SSE void SSEAdd(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		const __m128 value = _mm_set1_ps(fValue);
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			_mm_storeu_ps(pTarget + i, _mm_add_ps(_mm_loadu_ps(pTarget + i), value));
+		}
+
+		ScalarAdd(pTarget + i, fValue, nCount - i);
+	}
+
+	FENN_TARGET_SSE void SSEAddWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		const __m128 weight = _mm_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			const __m128 weighted = _mm_mul_ps(weight, _mm_loadu_ps(pSource + i));
+			_mm_storeu_ps(pTarget + i, _mm_add_ps(_mm_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarAddWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_SSE void SSESubtractWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		const __m128 weight = _mm_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			const __m128 weighted = _mm_mul_ps(weight, _mm_loadu_ps(pSource + i));
+			_mm_storeu_ps(pTarget + i, _mm_sub_ps(_mm_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarSubtractWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_SSE void SSEMultiplyWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		const __m128 weight = _mm_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			const __m128 weighted = _mm_mul_ps(weight, _mm_loadu_ps(pSource + i));
+			_mm_storeu_ps(pTarget + i, _mm_mul_ps(_mm_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarMultiplyWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_SSE void SSEDivide(VALUE_TYPE *pTarget, const VALUE_TYPE *pNumerator, const VALUE_TYPE *pDenominator, const unsigned int nCount)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			//divide all lanes, then clear the lanes which were divided by zero
+			const __m128 denominator = _mm_loadu_ps(pDenominator + i);
+			const __m128 quotient = _mm_div_ps(_mm_loadu_ps(pNumerator + i), denominator);
+			_mm_storeu_ps(pTarget + i, _mm_and_ps(quotient, _mm_cmpneq_ps(denominator, zero)));
+		}
+
+		ScalarDivide(pTarget + i, pNumerator + i, pDenominator + i, nCount - i);
+	}
+
+	//----------------------------------------------------------------
+	// AVX2 kernels (8 samples at once)
+	//----------------------------------------------------------------
+	FENN_TARGET_AVX2 void AVX2Fill(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		const __m256 value = _mm256_set1_ps(fValue);
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			_mm256_storeu_ps(pTarget + i, value);
+		}
+
+		ScalarFill(pTarget + i, fValue, nCount - i);
+	}
+
+	FENN_TARGET_AVX2 void AVX2Add(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount)
+	{
+		const __m256 value = _mm256_set1_ps(fValue);
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			_mm256_storeu_ps(pTarget + i, _mm256_add_ps(_mm256_loadu_ps(pTarget + i), value));
+		}
+
+		ScalarAdd(pTarget + i, fValue, nCount - i);
+	}
+
+	FENN_TARGET_AVX2 void AVX2AddWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		//note that no fused multiply-add is used, such that the results match the scalar kernels
+		const __m256 weight = _mm256_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			const __m256 weighted = _mm256_mul_ps(weight, _mm256_loadu_ps(pSource + i));
+			_mm256_storeu_ps(pTarget + i, _mm256_add_ps(_mm256_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarAddWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_AVX2 void AVX2SubtractWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		const __m256 weight = _mm256_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			const __m256 weighted = _mm256_mul_ps(weight, _mm256_loadu_ps(pSource + i));
+			_mm256_storeu_ps(pTarget + i, _mm256_sub_ps(_mm256_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarSubtractWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_AVX2 void AVX2MultiplyWeighted(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount)
+	{
+		const __m256 weight = _mm256_set1_ps(fWeight);
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			const __m256 weighted = _mm256_mul_ps(weight, _mm256_loadu_ps(pSource + i));
+			_mm256_storeu_ps(pTarget + i, _mm256_mul_ps(_mm256_loadu_ps(pTarget + i), weighted));
+		}
+
+		ScalarMultiplyWeighted(pTarget + i, pSource + i, fWeight, nCount - i);
+	}
+
+	FENN_TARGET_AVX2 void AVX2Divide(VALUE_TYPE *pTarget, const VALUE_TYPE *pNumerator, const VALUE_TYPE *pDenominator, const unsigned int nCount)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		unsigned int i = 0;
+
+		for (; i + 8 <= nCount; i += 8) {
+			const __m256 denominator = _mm256_loadu_ps(pDenominator + i);
+			const __m256 quotient = _mm256_div_ps(_mm256_loadu_ps(pNumerator + i), denominator);
+			_mm256_storeu_ps(pTarget + i, _mm256_and_ps(quotient, _mm256_cmp_ps(denominator, zero, _CMP_NEQ_UQ)));
+		}
+
+		ScalarDivide(pTarget + i, pNumerator + i, pDenominator + i, nCount - i);
+	}
+
+	//----------------------------------------------------------------
+	// Instruction set detection
+	//----------------------------------------------------------------
+	void QueryCPUID(const unsigned int nLeaf, const unsigned int nSubLeaf, unsigned int pRegisters[4])
+	{
+#if defined(_MSC_VER)
+		int pInfo[4];
+		__cpuidex(pInfo, (int)nLeaf, (int)nSubLeaf);
+
+		for (unsigned int i = 0; i < 4; i++) {
+			pRegisters[i] = (unsigned int)pInfo[i];
+		}
+#else
+		__cpuid_count(nLeaf, nSubLeaf, pRegisters[0], pRegisters[1], pRegisters[2], pRegisters[3]);
+#endif
+	}
+
+	bool IsAVXStateEnabled()
+	{
+		//the operating system should save the SSE and AVX registers on a context switch
+#if defined(_MSC_VER)
+		const unsigned long long nXCR0 = _xgetbv(0);
+#else
+		unsigned int nLow, nHigh;
+		__asm__ __volatile__ ("xgetbv" : "=a" (nLow), "=d" (nHigh) : "c" (0));
+		const unsigned long long nXCR0 = ((unsigned long long)nHigh << 32) | nLow;
+#endif
+		return (nXCR0 & 0x6) == 0x6;
+	}
+
+	fenn::InstructionSet DetectInstructionSet()
+	{
+		unsigned int pRegisters[4];
+		QueryCPUID(0, 0, pRegisters);
+		const unsigned int nMaxLeaf = pRegisters[0];
+
+		if (nMaxLeaf < 1) {
+			return fenn::INSTRUCTIONSET_SCALAR;
+		}
+
+		QueryCPUID(1, 0, pRegisters);
+		const bool bSSE2 = (pRegisters[3] & (1u << 26)) != 0;
+		const bool bOSXSAVE = (pRegisters[2] & (1u << 27)) != 0;
+		const bool bAVX = (pRegisters[2] & (1u << 28)) != 0;
+
+		if (!bSSE2) {
+			return fenn::INSTRUCTIONSET_SCALAR;
+		}
+
+		if (nMaxLeaf >= 7 && bOSXSAVE && bAVX && IsAVXStateEnabled()) {
+			QueryCPUID(7, 0, pRegisters);
+
+			if (pRegisters[1] & (1u << 5)) {
+				return fenn::INSTRUCTIONSET_AVX2;
+			}
+		}
+
+		return fenn::INSTRUCTIONSET_SSE;
+	}
+#endif
+
+	//the kernel tables, indexed by instruction set
+	const fenn::BrainKernels g_pKernels[fenn::INSTRUCTIONSET_TOTAL] = {
+		{ ScalarFill, ScalarAdd, ScalarAddWeighted, ScalarSubtractWeighted, ScalarMultiplyWeighted, ScalarDivide },
+#ifdef FENN_KERNELS_X86
+		{ SSEFill, SSEAdd, SSEAddWeighted, SSESubtractWeighted, SSEMultiplyWeighted, SSEDivide },
+		{ AVX2Fill, AVX2Add, AVX2AddWeighted, AVX2SubtractWeighted, AVX2MultiplyWeighted, AVX2Divide },
+#else
+		{ ScalarFill, ScalarAdd, ScalarAddWeighted, ScalarSubtractWeighted, ScalarMultiplyWeighted, ScalarDivide },
+		{ ScalarFill, ScalarAdd, ScalarAddWeighted, ScalarSubtractWeighted, ScalarMultiplyWeighted, ScalarDivide },
+#endif
+	};
+}
+
+fenn::InstructionSet fenn::GetSupportedInstructionSet()
+{
+	//the detection is only performed once, the result cannot change while running
+#ifdef FENN_KERNELS_X86
+	static const InstructionSet eSupported = DetectInstructionSet();
+	return eSupported;
+#else
+	return INSTRUCTIONSET_SCALAR;
+#endif
+}
+
+const fenn::BrainKernels& fenn::GetBrainKernels()
+{
+	return g_pKernels[GetSupportedInstructionSet()];
+}
+
+const fenn::BrainKernels& fenn::GetBrainKernels(const InstructionSet eInstructionSet)
+{
+	//never hand out kernels the processor cannot execute
+	assert(eInstructionSet < INSTRUCTIONSET_TOTAL);
+	const InstructionSet eSupported = GetSupportedInstructionSet();
+	return g_pKernels[eInstructionSet < eSupported ? eInstructionSet : eSupported];
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef FENN_BRAINKERNELS_H
+#define FENN_BRAINKERNELS_H
+
+#include "FENNConfig.h"
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Enumeration - InstructionSet
+	//----------------------------------------------------------------
+	// The instruction sets for which the brain kernels are available.
+	// The best supported instruction set is detected at runtime.
+	//----------------------------------------------------------------
+	enum InstructionSet
+	{
+		INSTRUCTIONSET_SCALAR = 0,
+		INSTRUCTIONSET_SSE = 1,
+		INSTRUCTIONSET_AVX2 = 2,
+		INSTRUCTIONSET_TOTAL = 3,
+	};
+
+	//----------------------------------------------------------------
+	// Structure - BrainKernels
+	//----------------------------------------------------------------
+	// The elementary operations used to evaluate a neuron over a row
+	// of samples during batch evaluation. Every neuron type of the
+	// brain is evaluated as a sequence of these operations, in the
+	// same order as the single sample evaluation such that both
+	// produce exactly the same values.
+	//----------------------------------------------------------------
+	struct BrainKernels
+	{
+		//pTarget[i] = fValue
+		void (*Fill)(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount);
+
+		//pTarget[i] += fValue
+		void (*Add)(VALUE_TYPE *pTarget, const VALUE_TYPE fValue, const unsigned int nCount);
+
+		//pTarget[i] += fWeight * pSource[i]
+		void (*AddWeighted)(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount);
+
+		//pTarget[i] -= fWeight * pSource[i]
+		void (*SubtractWeighted)(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount);
+
+		//pTarget[i] *= fWeight * pSource[i]
+		void (*MultiplyWeighted)(VALUE_TYPE *pTarget, const VALUE_TYPE *pSource, const WEIGHT_TYPE fWeight, const unsigned int nCount);
+
+		//pTarget[i] = pDenominator[i] != 0 ? pNumerator[i] / pDenominator[i] : 0
+		void (*Divide)(VALUE_TYPE *pTarget, const VALUE_TYPE *pNumerator, const VALUE_TYPE *pDenominator, const unsigned int nCount);
+	};
+
+	//retrieving the instruction set and kernels
+	InstructionSet GetSupportedInstructionSet();
+	const BrainKernels& GetBrainKernels();
+	const BrainKernels& GetBrainKernels(const InstructionSet eInstructionSet);
+}
+
+#endif
\ No newline at end of file
@@ -6,11 +6,21 @@ namespace fenn
 	//intentionally empty
 }
 
+//definitions - compiler support
+#if defined(_MSC_VER) && _MSC_VER < 1900
+	#define FENN_THREAD_LOCAL __declspec(thread) //only usable for plain data
+	#define FENN_NOEXCEPT
+#else
+	#define FENN_THREAD_LOCAL thread_local
+	#define FENN_NOEXCEPT noexcept //allows containers to move instead of copy when growing
+#endif
+
 //typedefinitions
 typedef float WEIGHT_TYPE;
 typedef float BIAS_TYPE;
 typedef float VALUE_TYPE;
 typedef float CHANCE_TYPE;
+typedef float FITNESS_TYPE;
 typedef unsigned int GLOBAL_INDEX_TYPE;
 typedef unsigned short LOCAL_INDEX_TYPE;
 typedef unsigned char SLOT_INDEX_TYPE;
@@ -19,6 +29,7 @@ typedef unsigned char SLOT_INDEX_TYPE;
 #define WEIGHT_DEFAULT (WEIGHT_TYPE)(1.0f)
 #define BIAS_DEFAULT (BIAS_TYPE)(0.0f)
 #define SLOT_DEFAULT (SLOT_INDEX_TYPE)(0)
+#define FITNESS_DEFAULT (FITNESS_TYPE)(0.0f)
 
 //definitions - minima and maxima
 #define SLOT_MAX (SLOT_INDEX_TYPE)(1)
@@ -39,4 +50,36 @@ typedef unsigned char SLOT_INDEX_TYPE;
 #define BIAS_RANGE (BIAS_TYPE)(BIAS_MAX - BIAS_MIN)
 #define BIAS_ADDITIVE_RANGE (BIAS_TYPE)(BIAS_ADDITIVE_MAX - BIAS_ADDITIVE_MIN)
 
+//definitions - innovation indices
+#define WORLD_INDEX_BLOCK_SIZE (GLOBAL_INDEX_TYPE)(64) //number of indices a thread reserves at once
+#define INNOVATION_SHARD_COUNT (unsigned int)(64) //number of independently locked parts of an innovation registry
+#define INNOVATION_SHARD_CAPACITY (unsigned int)(16) //initial number of entries of every innovation registry shard
+
+//definitions - fitness cache
+#define FITNESS_CACHE_SHARD_COUNT (unsigned int)(64) //number of independently locked parts of a fitness cache
+#define FITNESS_CACHE_SHARD_CAPACITY (unsigned int)(16) //initial number of entries of every fitness cache shard
+#define FITNESS_CACHE_SHARD_MAX (unsigned int)(4096) //number of entries after which a fitness cache shard is cleared
+
+//definitions - speciation
+#define SPECIES_COEFFICIENT_EXCESS (float)(1.0f) //importance of the excess genes in the compatibility distance
+#define SPECIES_COEFFICIENT_DISJOINT (float)(1.0f) //importance of the disjoint genes in the compatibility distance
+#define SPECIES_COEFFICIENT_WEIGHT (float)(0.4f) //importance of the weight differences in the compatibility distance
+#define SPECIES_THRESHOLD (float)(3.0f) //compatibility distance below which genomes belong to the same species
+#define SPECIES_CHUNK_SIZE (unsigned int)(16) //number of genomes compared by a single task when dividing a population into species
+
+//definitions - population
+#define POPULATION_ELITES (unsigned int)(1) //number of the fittest genomes copied unchanged into the next generation
+#define POPULATION_TOURNAMENT_SIZE (unsigned int)(3) //number of random genomes competing to become a parent
+
+//definitions - memory
+#define RNA_CONNECTION_RESERVE (unsigned int)(4) //minimum number of connections reserved for a neuron whose connections are moved while mutating
+#define RNA_SEARCH_INLINE (unsigned int)(16) //number of neurons a reordering search stores without allocating memory
+#define RNA_EDGE_INDEX_CAPACITY (unsigned int)(16) //initial number of entries of the edge index of an RNA string
+
+//definitions - population snapshots
+#define SNAPSHOT_NO_CHAMPION (unsigned int)(~0u) //champion index of a snapshot saved without fitness values
+
+//definitions - evaluation
+#define BRAIN_TILE_SIZE (unsigned int)(64) //number of samples evaluated at once in a batch
+
 #endif
\ No newline at end of file
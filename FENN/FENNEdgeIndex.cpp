@@ -0,0 +1,64 @@
+#include "FENNEdgeIndex.h"
+
+namespace
+{
+	inline unsigned long long GetKey(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget)
+	{
+		return ((unsigned long long)nSource << 32) | (unsigned long long)nTarget;
+	}
+}
+
+fenn::EdgeIndex::EdgeIndex()
+{
+}
+
+void fenn::EdgeIndex::Clear()
+{
+	m_table.Clear();
+}
+
+void fenn::EdgeIndex::Reserve(const unsigned int nEdges)
+{
+	//small RNA strings start out with the default capacity, such that they do not grow repeatedly
+	m_table.Reserve(nEdges * 2 > RNA_EDGE_INDEX_CAPACITY ? nEdges : RNA_EDGE_INDEX_CAPACITY / 2);
+}
+
+unsigned int fenn::EdgeIndex::GetNumEdges() const
+{
+	return m_table.GetNumEntries();
+}
+
+bool fenn::EdgeIndex::Find(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget, GLOBAL_INDEX_TYPE *pConnection) const
+{
+	const GLOBAL_INDEX_TYPE* const pFound = m_table.Find(GetKey(nSource, nTarget));
+
+	if (pFound == NULL) {
+		return false;
+	}
+
+	if (pConnection) {
+		*pConnection = *pFound;
+	}
+
+	return true;
+}
+
+bool fenn::EdgeIndex::Insert(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget, const GLOBAL_INDEX_TYPE nConnection)
+{
+	Reserve(m_table.GetNumEntries() + 1);
+
+	bool bInserted;
+	GLOBAL_INDEX_TYPE &nValue = m_table.Insert(GetKey(nSource, nTarget), bInserted);
+
+	if (!bInserted) {
+		return false;
+	}
+
+	nValue = nConnection;
+	return true;
+}
+
+bool fenn::EdgeIndex::Erase(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget)
+{
+	return m_table.Erase(GetKey(nSource, nTarget));
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef FENN_EDGEINDEX_H
+#define FENN_EDGEINDEX_H
+
+#include "FENNConfig.h"
+#include "FENNHashTable.h"
+
+#include <cstddef>
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Class - EdgeIndex
+	//----------------------------------------------------------------
+	// Keeps track of the connections of a single RNA string by the
+	// pair of neurons they connect, such that whether two neurons are
+	// connected, and by which connection, is known without searching
+	// the connections of the source neuron. The neurons are
+	// identified by their global index, which does not change when
+	// the RNA string is compacted. The edges are stored in a hash
+	// table, hence every operation takes constant time on average.
+	// The index is a plain value, copying it copies the table.
+	//----------------------------------------------------------------
+	class EdgeIndex
+	{
+	public:
+		EdgeIndex();
+
+		//removing all edges, the memory of the table is kept
+		void Clear();
+		void Reserve(const unsigned int nEdges);
+
+		//retrieving the number of edges
+		unsigned int GetNumEdges() const;
+
+		//finding, adding and removing the edge between two neurons along with the index of its
+		//connection. Every pair of neurons is connected by at most one connection, adding an edge
+		//that already exists fails
+		bool Find(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget, GLOBAL_INDEX_TYPE *pConnection = NULL) const;
+		bool Insert(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget, const GLOBAL_INDEX_TYPE nConnection);
+		bool Erase(const GLOBAL_INDEX_TYPE nSource, const GLOBAL_INDEX_TYPE nTarget);
+
+	protected:
+		//the connection of every edge, keyed by the source in the upper and the target in the lower bits
+		HashTable<GLOBAL_INDEX_TYPE> m_table;
+	};
+}
+
+#endif
\ No newline at end of file
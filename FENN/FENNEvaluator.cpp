@@ -0,0 +1,120 @@
+#include "FENNEvaluator.h"
+#include "FENNRNA.h"
+#include "FENNFitnessCache.h"
+
+#include <cassert>
+#include <limits>
+
+namespace
+{
+	//the arguments of a single call to Evaluate(...). The work function only captures a reference
+	//to them, such that it fits into the small buffer of std::function and does not allocate
+	struct EvaluationArguments
+	{
+		const fenn::RNA* const		*ppGenomes;
+		const fenn::RNA				*pGenomes;
+		FITNESS_TYPE				*pFitness;
+		const fenn::PopulationEvaluator::FUNCTION_FITNESS *pFunction;
+	};
+}
+
+void fenn::EvaluationContext::Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput)
+{
+	brain.Evaluate(pInput, pOutput, veScratch.data());
+}
+
+void fenn::EvaluationContext::EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples)
+{
+	brain.EvaluateBatch(pInput, pOutput, nSamples, veScratch.data());
+}
+
+fenn::PopulationEvaluator::PopulationEvaluator()
+	: m_pCache(NULL)
+{
+	CreateContexts();
+}
+
+fenn::PopulationEvaluator::PopulationEvaluator(const unsigned int nThreads)
+	: m_scheduler(nThreads)
+	, m_pCache(NULL)
+{
+	CreateContexts();
+}
+
+fenn::PopulationEvaluator::~PopulationEvaluator()
+{
+	//nothing to do
+}
+
+unsigned int fenn::PopulationEvaluator::GetNumThreads() const
+{
+	return m_scheduler.GetNumThreads();
+}
+
+comt::TaskScheduler& fenn::PopulationEvaluator::GetScheduler()
+{
+	return m_scheduler;
+}
+
+void fenn::PopulationEvaluator::SetFitnessCache(FitnessCache *pCache)
+{
+	m_pCache = pCache;
+}
+
+void fenn::PopulationEvaluator::Evaluate(const RNA * const *ppGenomes, const unsigned int nGenomes, FITNESS_TYPE *pFitness, const FUNCTION_FITNESS &fitness)
+{
+	//every genome is a separate task, as the cost of evaluating a genome can differ greatly
+	//between genomes
+	const EvaluationArguments arguments = { ppGenomes, NULL, pFitness, &fitness };
+
+	m_scheduler.Run(nGenomes, [this, &arguments](const comt::TaskScheduler::Task &task, const unsigned int iThread) {
+		EvaluateGenome(*arguments.ppGenomes[task.nItem], task.nItem, arguments.pFitness, *arguments.pFunction, iThread);
+	});
+}
+
+void fenn::PopulationEvaluator::Evaluate(const std::vector<RNA> &vePopulation, std::vector<FITNESS_TYPE> &veFitness, const FUNCTION_FITNESS &fitness)
+{
+	veFitness.resize(vePopulation.size());
+	const EvaluationArguments arguments = { NULL, vePopulation.data(), veFitness.data(), &fitness };
+
+	m_scheduler.Run(vePopulation.size(), [this, &arguments](const comt::TaskScheduler::Task &task, const unsigned int iThread) {
+		EvaluateGenome(arguments.pGenomes[task.nItem], task.nItem, arguments.pFitness, *arguments.pFunction, iThread);
+	});
+}
+
+void fenn::PopulationEvaluator::EvaluateGenome(const RNA &genome, const unsigned int iGenome, FITNESS_TYPE *pFitness, const FUNCTION_FITNESS &fitness, const unsigned int iThread)
+{
+	assert(iThread < m_veContexts.size());
+	EvaluationContext &context = m_veContexts[iThread];
+
+	//genes evaluated before do not have to be compiled nor evaluated again
+	if (m_pCache != NULL && m_pCache->Find(genome.GetHash(), &pFitness[iGenome])) {
+		return;
+	}
+
+	//compile the genome into the thread's brain, reusing the buffers of the previous genome
+	context.brain.Compile(genome);
+
+	if (context.veScratch.size() < context.brain.GetBatchScratchSize()) {
+		context.veScratch.resize(context.brain.GetBatchScratchSize());
+	}
+
+	//a fitness which is not a number cannot be ordered, hence it is stored as the lowest fitness
+	//such that ranking, tournaments and the champion treat the genome as the worst one
+	const FITNESS_TYPE fFitness = fitness(iGenome, context);
+	pFitness[iGenome] = fFitness == fFitness ? fFitness : std::numeric_limits<FITNESS_TYPE>::lowest();
+
+	if (m_pCache != NULL) {
+		m_pCache->Insert(genome.GetHash(), pFitness[iGenome]);
+	}
+}
+
+void fenn::PopulationEvaluator::CreateContexts()
+{
+	//one context per thread, such that threads never share a brain or scratch buffer
+	m_veContexts.resize(m_scheduler.GetNumThreads());
+
+	for (unsigned int i = 0; i < m_veContexts.size(); i++) {
+		m_veContexts[i].nThread = i;
+	}
+}
\ No newline at end of file
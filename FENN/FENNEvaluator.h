@@ -0,0 +1,97 @@
+#ifndef FENN_EVALUATOR_H
+#define FENN_EVALUATOR_H
+
+#include "FENNConfig.h"
+#include "FENNBrain.h"
+
+#include <COMTTaskScheduler.h>
+
+#include <vector>
+#include <functional>
+
+namespace fenn
+{
+	//forward definitions
+	class RNA;
+	class FitnessCache;
+
+	//----------------------------------------------------------------
+	// Structure - EvaluationContext
+	//----------------------------------------------------------------
+	// The data owned by a single evaluation thread. The brain is
+	// recompiled for every genome the thread evaluates and the
+	// scratch buffer is large enough for both single sample and batch
+	// evaluation. As both are reused, evaluating genomes of similar
+	// sizes does not require any allocations.
+	//----------------------------------------------------------------
+	struct EvaluationContext
+	{
+		//evaluating the brain of the genome currently being evaluated
+		void Evaluate(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput);
+		void EvaluateBatch(const VALUE_TYPE *pInput, VALUE_TYPE *pOutput, const unsigned int nSamples);
+
+		//structure members
+		unsigned int			nThread;
+		Brain					brain;
+		std::vector<VALUE_TYPE>	veScratch;
+	};
+
+	//----------------------------------------------------------------
+	// Class - PopulationEvaluator
+	//----------------------------------------------------------------
+	// Evaluates the fitness of an entire population using a
+	// persistent set of threads, every genome is a task of a work
+	// stealing scheduler. Every genome is compiled into the
+	// brain of the evaluating thread's context, after which the
+	// fitness function is called with the index of the genome and
+	// the context. The fitness function is called concurrently from
+	// multiple threads and should therefore only modify data that
+	// belongs to the passed genome index or context thread. The
+	// resulting fitness values are written directly into the fitness
+	// array, no locks are involved. A fitness which is not a number
+	// is stored as the lowest possible fitness, such that every
+	// stored fitness can be ordered. Optionally a fitness cache can
+	// be set, in which case genomes whose hash is found in the cache
+	// are neither compiled nor passed to the fitness function. This
+	// is only valid when the fitness function is deterministic and
+	// only depends on the genome.
+	//----------------------------------------------------------------
+	class PopulationEvaluator
+	{
+	public:
+		typedef std::function<FITNESS_TYPE (const unsigned int iGenome, EvaluationContext &context)> FUNCTION_FITNESS;
+
+		//constructors and destructor
+		PopulationEvaluator();
+		explicit PopulationEvaluator(const unsigned int nThreads);
+		~PopulationEvaluator();
+
+		//retrieving the number of evaluation threads
+		unsigned int GetNumThreads() const;
+		comt::TaskScheduler& GetScheduler(); //can be used for other work in between evaluations
+
+		//setting the cache used to skip evaluating previously evaluated genes, or NULL to evaluate every genome
+		void SetFitnessCache(FitnessCache *pCache);
+
+		//evaluating the population
+		void Evaluate(const RNA * const *ppGenomes, const unsigned int nGenomes, FITNESS_TYPE *pFitness, const FUNCTION_FITNESS &fitness);
+		void Evaluate(const std::vector<RNA> &vePopulation, std::vector<FITNESS_TYPE> &veFitness, const FUNCTION_FITNESS &fitness);
+
+		//evaluating a single genome using the context of the given thread, for callers distributing
+		//the genomes over GetNumThreads() threads themselves. The fitness is stored in pFitness[iGenome]
+		void EvaluateGenome(const RNA &genome, const unsigned int iGenome, FITNESS_TYPE *pFitness, const FUNCTION_FITNESS &fitness, const unsigned int iThread);
+
+	protected:
+		comt::TaskScheduler				m_scheduler;
+		std::vector<EvaluationContext>	m_veContexts;
+		FitnessCache					*m_pCache;
+
+	private:
+		PopulationEvaluator(const PopulationEvaluator &evaluator);
+		void operator = (const PopulationEvaluator &evaluator);
+
+		void CreateContexts();
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "FENNFitnessCache.h"
+
+#include <cassert>
+#include <cstddef>
+
+fenn::FitnessCache::FitnessCache()
+	: m_pShards(NULL)
+	, m_nShards(0)
+{
+	Initialize(FITNESS_CACHE_SHARD_COUNT);
+}
+
+fenn::FitnessCache::FitnessCache(const unsigned int nShards)
+	: m_pShards(NULL)
+	, m_nShards(0)
+{
+	Initialize(nShards);
+}
+
+fenn::FitnessCache::~FitnessCache()
+{
+	delete[] m_pShards;
+}
+
+void fenn::FitnessCache::Clear()
+{
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		m_pShards[i].table.Clear();
+	}
+}
+
+bool fenn::FitnessCache::Find(const unsigned long long nHash, FITNESS_TYPE *pFitness)
+{
+	Shard &shard = GetShard(nHash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	const FITNESS_TYPE* const pFound = shard.table.Find(nHash);
+
+	if (pFound == NULL) {
+		shard.nMisses++;
+		return false;
+	}
+
+	shard.nHits++;
+	*pFitness = *pFound;
+	return true;
+}
+
+void fenn::FitnessCache::Insert(const unsigned long long nHash, const FITNESS_TYPE fFitness)
+{
+	Shard &shard = GetShard(nHash);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	//a full shard starts over
+	if (shard.table.GetNumEntries() >= FITNESS_CACHE_SHARD_MAX && shard.table.Find(nHash) == NULL) {
+		shard.table.Clear();
+	}
+
+	bool bInserted;
+	shard.table.Insert(nHash, bInserted) = fFitness;
+}
+
+unsigned int fenn::FitnessCache::GetNumEntries()
+{
+	unsigned int nTotal = 0;
+
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		nTotal += m_pShards[i].table.GetNumEntries();
+	}
+
+	return nTotal;
+}
+
+unsigned long long fenn::FitnessCache::GetNumHits()
+{
+	unsigned long long nTotal = 0;
+
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		nTotal += m_pShards[i].nHits;
+	}
+
+	return nTotal;
+}
+
+unsigned long long fenn::FitnessCache::GetNumMisses()
+{
+	unsigned long long nTotal = 0;
+
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		nTotal += m_pShards[i].nMisses;
+	}
+
+	return nTotal;
+}
+
+void fenn::FitnessCache::Initialize(const unsigned int nShards)
+{
+	//the number of shards is a power of two, such that the hash can be masked
+	assert(nShards > 0 && (nShards & (nShards - 1)) == 0);
+
+	m_nShards = nShards;
+	m_pShards = new Shard[nShards];
+
+	for (unsigned int i = 0; i < nShards; i++) {
+		Shard &shard = m_pShards[i];
+		shard.nHits = 0;
+		shard.nMisses = 0;
+		shard.table.Reserve(FITNESS_CACHE_SHARD_CAPACITY / 2);
+	}
+}
+
+fenn::FitnessCache::Shard& fenn::FitnessCache::GetShard(const unsigned long long nHash)
+{
+	return m_pShards[(unsigned int)(nHash >> 40) & (m_nShards - 1)];
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef FENN_FITNESSCACHE_H
+#define FENN_FITNESSCACHE_H
+
+#include "FENNConfig.h"
+#include "FENNHashTable.h"
+
+#include <mutex>
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Class - FitnessCache
+	//----------------------------------------------------------------
+	// Remembers the fitness of the genomes evaluated before, keyed by
+	// the hash of their genes (see RNA::GetHash()). Children which
+	// are identical to a parent or to a sibling therefore do not have
+	// to be evaluated again. This is only valid when the fitness of a
+	// genome depends on nothing but its genes. The entries are stored
+	// in hash tables divided into shards, each protected by its own
+	// lock, such that many threads can use the cache simultaneously.
+	// The cache outlives generations, a shard is cleared once it
+	// holds FITNESS_CACHE_SHARD_MAX entries. Clear() should be called
+	// whenever the fitness function changes.
+	//----------------------------------------------------------------
+	class FitnessCache
+	{
+	public:
+		//constructors and destructor
+		FitnessCache();
+		explicit FitnessCache(const unsigned int nShards);
+		~FitnessCache();
+
+		//forgetting all entries
+		void Clear();
+
+		//retrieving and storing the fitness of the genes with the given hash
+		bool Find(const unsigned long long nHash, FITNESS_TYPE *pFitness);
+		void Insert(const unsigned long long nHash, const FITNESS_TYPE fFitness);
+
+		//retrieving statistics, the number of lookups that did and did not find an entry
+		unsigned int GetNumEntries();
+		unsigned long long GetNumHits();
+		unsigned long long GetNumMisses();
+
+	protected:
+		//----------------------------------------------------------------
+		// Structure - Shard
+		//----------------------------------------------------------------
+		// A part of the cache with its own lock and hash table, mapping
+		// the hash of the genes to their fitness.
+		//----------------------------------------------------------------
+		struct Shard
+		{
+			std::mutex				mutex;
+			unsigned long long		nHits;
+			unsigned long long		nMisses;
+			HashTable<FITNESS_TYPE>	table;
+		};
+
+		Shard					*m_pShards;
+		unsigned int			m_nShards;
+
+	private:
+		FitnessCache(const FitnessCache &cache);
+		void operator = (const FitnessCache &cache);
+
+		void Initialize(const unsigned int nShards);
+		Shard& GetShard(const unsigned long long nHash);
+	};
+}
+
+#endif
\ No newline at end of file
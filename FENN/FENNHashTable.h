@@ -0,0 +1,194 @@
+#ifndef FENN_HASHTABLE_H
+#define FENN_HASHTABLE_H
+
+#include "FENNConfig.h"
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace fenn
+{
+	//the 64 bit finalizer of MurmurHash3, which spreads every bit of the value over all bits of
+	//the result
+	inline unsigned long long MixHash(unsigned long long nValue)
+	{
+		nValue = (nValue ^ (nValue >> 33)) * 0xFF51AFD7ED558CCDULL;
+		nValue = (nValue ^ (nValue >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+		return nValue ^ (nValue >> 33);
+	}
+
+	//----------------------------------------------------------------
+	// Class - HashTable
+	//----------------------------------------------------------------
+	// An open addressing hash table mapping 64 bit keys to values,
+	// using linear probing starting at the mixed key. The size of the
+	// table is a power of two and the table is kept at most half
+	// full. Every entry carries the stamp of the table at the time it
+	// was inserted, entries with another stamp are unused. Clearing
+	// the table therefore only changes its stamp, the entries are
+	// only reset when the stamp wraps around. Erasing a key shifts
+	// the following entries of its probe sequence back, hence the
+	// table never contains deleted entries. The table is a plain
+	// value, copying it copies the entries, and it is not locked.
+	//----------------------------------------------------------------
+	template <class VALUE> class HashTable
+	{
+	public:
+		HashTable()
+			: m_nNumEntries(0)
+			, m_nStamp(1)
+		{
+		}
+
+		//removing all entries, the memory of the table is kept
+		void Clear()
+		{
+			m_nNumEntries = 0;
+
+			if (++m_nStamp == 0) {
+				for (auto &entry : m_veEntries) {
+					entry.nStamp = 0;
+				}
+
+				m_nStamp = 1;
+			}
+		}
+
+		//making room for the given number of entries, such that inserting them does not grow the table
+		void Reserve(const unsigned int nEntries)
+		{
+			unsigned int nSize = m_veEntries.empty() ? 1 : m_veEntries.size();
+
+			while (nSize < nEntries * 2) {
+				nSize *= 2;
+			}
+
+			if (nSize > m_veEntries.size()) {
+				Grow(nSize);
+			}
+		}
+
+		//retrieving the number of entries
+		unsigned int GetNumEntries() const
+		{
+			return m_nNumEntries;
+		}
+
+		//finding the value of a key, or NULL when the key is not in the table
+		const VALUE* Find(const unsigned long long nKey) const
+		{
+			if (m_nNumEntries == 0) {
+				return NULL;
+			}
+
+			const Entry &entry = m_veEntries[FindPosition(nKey)];
+			return entry.nStamp == m_nStamp ? &entry.value : NULL;
+		}
+
+		VALUE* Find(const unsigned long long nKey)
+		{
+			return const_cast<VALUE*>(static_cast<const HashTable&>(*this).Find(nKey));
+		}
+
+		//finding the value of a key, or adding the key with a value-initialized value when it is
+		//not in the table yet. The latter is indicated by bInserted
+		VALUE& Insert(const unsigned long long nKey, bool &bInserted)
+		{
+			if (m_nNumEntries > 0) {
+				Entry &entry = m_veEntries[FindPosition(nKey)];
+
+				if (entry.nStamp == m_nStamp) {
+					bInserted = false;
+					return entry.value;
+				}
+			}
+
+			if ((m_nNumEntries + 1) * 2 > m_veEntries.size()) {
+				Reserve(m_nNumEntries + 1);
+			}
+
+			Entry &entry = m_veEntries[FindPosition(nKey)];
+			entry.nKey = nKey;
+			entry.value = VALUE();
+			entry.nStamp = m_nStamp;
+			m_nNumEntries++;
+			bInserted = true;
+			return entry.value;
+		}
+
+		//removing a key, returns whether it was in the table
+		bool Erase(const unsigned long long nKey)
+		{
+			if (m_nNumEntries == 0) {
+				return false;
+			}
+
+			const unsigned int nMask = m_veEntries.size() - 1;
+			unsigned int nEmpty = FindPosition(nKey);
+
+			if (m_veEntries[nEmpty].nStamp != m_nStamp) {
+				return false;
+			}
+
+			//move the following entries of the probe sequence back into the hole, unless that would
+			//place them before their own position. The sequence ends at the first unused entry
+			for (unsigned int i = (nEmpty + 1) & nMask; m_veEntries[i].nStamp == m_nStamp; i = (i + 1) & nMask) {
+				const unsigned int nHome = (unsigned int)MixHash(m_veEntries[i].nKey) & nMask;
+
+				//the entry may move if its home position does not lie in (nEmpty, i], cyclically
+				if (((i - nHome) & nMask) >= ((i - nEmpty) & nMask)) {
+					m_veEntries[nEmpty] = m_veEntries[i];
+					nEmpty = i;
+				}
+			}
+
+			m_veEntries[nEmpty].nStamp = 0;
+			m_nNumEntries--;
+			return true;
+		}
+
+	private:
+		//the stamp is never zero for an entry in use
+		struct Entry
+		{
+			unsigned long long		nKey;
+			VALUE					value;
+			unsigned int			nStamp;
+		};
+
+		std::vector<Entry>		m_veEntries;
+		unsigned int			m_nNumEntries;
+		unsigned int			m_nStamp;
+
+		unsigned int FindPosition(const unsigned long long nKey) const
+		{
+			//returns either the position of the key or the unused entry at which it would be inserted
+			const unsigned int nMask = m_veEntries.size() - 1;
+			unsigned int i = (unsigned int)MixHash(nKey) & nMask;
+
+			while (m_veEntries[i].nStamp == m_nStamp && m_veEntries[i].nKey != nKey) {
+				i = (i + 1) & nMask;
+			}
+
+			return i;
+		}
+
+		void Grow(const unsigned int nSize)
+		{
+			//move all entries to the larger table, of which all entries are unused
+			assert((nSize & (nSize - 1)) == 0);
+			std::vector<Entry> veOld;
+			veOld.swap(m_veEntries);
+			m_veEntries.resize(nSize);
+
+			for (const auto &entry : veOld) {
+				if (entry.nStamp == m_nStamp) {
+					m_veEntries[FindPosition(entry.nKey)] = entry;
+				}
+			}
+		}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "FENNInnovation.h"
+#include "FENNWorld.h"
+
+#include <cassert>
+#include <cstddef>
+
+namespace
+{
+	inline unsigned long long GetKey(const GLOBAL_INDEX_TYPE nOrigin, const GLOBAL_INDEX_TYPE nTarget)
+	{
+		return ((unsigned long long)nOrigin << 32) | (unsigned long long)nTarget;
+	}
+}
+
+fenn::InnovationRegistry::InnovationRegistry()
+	: m_pShards(NULL)
+	, m_nShards(0)
+{
+	Initialize(INNOVATION_SHARD_COUNT);
+}
+
+fenn::InnovationRegistry::InnovationRegistry(const unsigned int nShards)
+	: m_pShards(NULL)
+	, m_nShards(0)
+{
+	Initialize(nShards);
+}
+
+fenn::InnovationRegistry::~InnovationRegistry()
+{
+	delete[] m_pShards;
+}
+
+void fenn::InnovationRegistry::Reset()
+{
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		m_pShards[i].neurons.Clear();
+		m_pShards[i].connections.Clear();
+	}
+}
+
+fenn::NeuronMutation fenn::InnovationRegistry::GetNeuronMutation(const GLOBAL_INDEX_TYPE nOrigin, const GLOBAL_INDEX_TYPE nTarget)
+{
+	const unsigned long long nKey = GetKey(nOrigin, nTarget);
+	Shard &shard = GetShard(nKey);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	bool bInserted;
+	NeuronMutation &mutation = shard.neurons.Insert(nKey, bInserted);
+
+	if (bInserted) {
+		//the mutation did not occur before, retrieve the new indices while holding the lock such
+		//that all threads use the same indices for the same mutation
+		mutation.nNeuronOrigin			= nOrigin;
+		mutation.nNeuronTarget			= nTarget;
+		mutation.nNewNeuronIndex		= world_single::Get().GetNewNeuronIndex();
+		mutation.nNewConnectionTowards	= world_single::Get().GetNewConnectionIndex();
+		mutation.nNewConnectionFrom		= world_single::Get().GetNewConnectionIndex();
+	}
+
+	return mutation;
+}
+
+fenn::ConnectionMutation fenn::InnovationRegistry::GetConnectionMutation(const GLOBAL_INDEX_TYPE nOrigin, const GLOBAL_INDEX_TYPE nTarget)
+{
+	const unsigned long long nKey = GetKey(nOrigin, nTarget);
+	Shard &shard = GetShard(nKey);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	bool bInserted;
+	ConnectionMutation &mutation = shard.connections.Insert(nKey, bInserted);
+
+	if (bInserted) {
+		mutation.nNeuronOrigin			= nOrigin;
+		mutation.nNeuronTarget			= nTarget;
+		mutation.nNewConnectionIndex	= world_single::Get().GetNewConnectionIndex();
+	}
+
+	return mutation;
+}
+
+unsigned int fenn::InnovationRegistry::GetNumNeuronMutations()
+{
+	unsigned int nTotal = 0;
+
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		nTotal += m_pShards[i].neurons.GetNumEntries();
+	}
+
+	return nTotal;
+}
+
+unsigned int fenn::InnovationRegistry::GetNumConnectionMutations()
+{
+	unsigned int nTotal = 0;
+
+	for (unsigned int i = 0; i < m_nShards; i++) {
+		std::lock_guard<std::mutex> lock(m_pShards[i].mutex);
+		nTotal += m_pShards[i].connections.GetNumEntries();
+	}
+
+	return nTotal;
+}
+
+void fenn::InnovationRegistry::Initialize(const unsigned int nShards)
+{
+	//the number of shards is a power of two, such that the hash can be masked
+	assert(nShards > 0 && (nShards & (nShards - 1)) == 0);
+
+	m_nShards = nShards;
+	m_pShards = new Shard[nShards];
+
+	for (unsigned int i = 0; i < nShards; i++) {
+		m_pShards[i].neurons.Reserve(INNOVATION_SHARD_CAPACITY / 2);
+		m_pShards[i].connections.Reserve(INNOVATION_SHARD_CAPACITY / 2);
+	}
+}
+
+fenn::InnovationRegistry::Shard& fenn::InnovationRegistry::GetShard(const unsigned long long nKey)
+{
+	//the shard is selected by the upper bits of the mixed key, the table uses the lower bits
+	return m_pShards[(unsigned int)(MixHash(nKey) >> 40) & (m_nShards - 1)];
+}
\ No newline at end of file
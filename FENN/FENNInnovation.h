@@ -0,0 +1,106 @@
+#ifndef FENN_INNOVATION_H
+#define FENN_INNOVATION_H
+
+#include "FENNConfig.h"
+#include "FENNHashTable.h"
+
+#include <mutex>
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Structure - NeuronMutation
+	//----------------------------------------------------------------
+	// When mutating multiple RNA strings within the same generation
+	// the possiblity exists that the exact same mutation occurs
+	// twice. In this case the newly created neuron should receive the
+	// same global index as the previously generated neuron. This
+	// structure helps in tracking those neuron mutations
+	//----------------------------------------------------------------
+	struct NeuronMutation
+	{
+		GLOBAL_INDEX_TYPE		nNeuronOrigin;		//index of the neuron connected to the new neuron
+		GLOBAL_INDEX_TYPE		nNeuronTarget;		//index of the neuron that this neuron connects to
+		GLOBAL_INDEX_TYPE		nNewNeuronIndex;	//index of the newly created neuron
+		GLOBAL_INDEX_TYPE		nNewConnectionTowards; //index of the new connection toward the newly created neuron
+		GLOBAL_INDEX_TYPE		nNewConnectionFrom;	//index of the new connection from the newly created neuron
+	};
+
+	//----------------------------------------------------------------
+	// Structure - ConnectionMutation
+	//----------------------------------------------------------------
+	// When mutation multiple RNA strings within the same generation
+	// the possiblity exists that the exact same connection mutation
+	// occurs twice. In this case the second occurrence should not
+	// request a new global connection index but reuse the old one.
+	// This structure helps keeping track of those mutations.
+	//----------------------------------------------------------------
+	struct ConnectionMutation
+	{
+		GLOBAL_INDEX_TYPE		nNeuronOrigin;
+		GLOBAL_INDEX_TYPE		nNeuronTarget;
+		GLOBAL_INDEX_TYPE		nNewConnectionIndex;
+	};
+
+	//----------------------------------------------------------------
+	// Class - InnovationRegistry
+	//----------------------------------------------------------------
+	// Keeps track of all structural mutations that occurred within a
+	// generation, identified by the indices of the origin and target
+	// neurons. Retrieving a mutation returns the previously created
+	// mutation when it occurred before, or creates a new one with new
+	// global indices otherwise. The mutations are stored in hash
+	// tables divided into shards, each protected by its own lock,
+	// such that many threads can mutate RNA simultaneously. Reset()
+	// should be called at the start of every generation, clearing the
+	// tables does not depend on the number of stored mutations.
+	// Reset() should not be called while other threads use the
+	// registry.
+	//----------------------------------------------------------------
+	class InnovationRegistry
+	{
+	public:
+		//constructors and destructor
+		InnovationRegistry();
+		explicit InnovationRegistry(const unsigned int nShards);
+		~InnovationRegistry();
+
+		//starting a new generation, forgetting all previous mutations
+		void Reset();
+
+		//retrieving (and creating if required) the mutations between two neurons
+		NeuronMutation GetNeuronMutation(const GLOBAL_INDEX_TYPE nOrigin, const GLOBAL_INDEX_TYPE nTarget);
+		ConnectionMutation GetConnectionMutation(const GLOBAL_INDEX_TYPE nOrigin, const GLOBAL_INDEX_TYPE nTarget);
+
+		//retrieving the number of mutations of the current generation
+		unsigned int GetNumNeuronMutations();
+		unsigned int GetNumConnectionMutations();
+
+	protected:
+		//----------------------------------------------------------------
+		// Structure - Shard
+		//----------------------------------------------------------------
+		// A part of the registry with its own lock and hash tables, the
+		// mutations are keyed by the origin neuron in the upper and the
+		// target neuron in the lower bits.
+		//----------------------------------------------------------------
+		struct Shard
+		{
+			std::mutex						mutex;
+			HashTable<NeuronMutation>		neurons;
+			HashTable<ConnectionMutation>	connections;
+		};
+
+		Shard					*m_pShards;
+		unsigned int			m_nShards;
+
+	private:
+		InnovationRegistry(const InnovationRegistry &registry);
+		void operator = (const InnovationRegistry &registry);
+
+		void Initialize(const unsigned int nShards);
+		Shard& GetShard(const unsigned long long nKey);
+	};
+}
+
+#endif
\ No newline at end of file
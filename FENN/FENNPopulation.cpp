@@ -0,0 +1,275 @@
+#include "FENNPopulation.h"
+#include "FENNRandom.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace
+{
+	//the tasks which are processed for every child
+	enum ChildStage
+	{
+		CHILDSTAGE_PRODUCE = 0,
+		CHILDSTAGE_EVALUATE = 1,
+	};
+
+	struct CompareFitness {
+		explicit CompareFitness(const FITNESS_TYPE *pFitness) : pFitness(pFitness) {}
+		bool operator () (const unsigned int nFirst, const unsigned int nSecond) const { return pFitness[nFirst] > pFitness[nSecond] || (pFitness[nFirst] == pFitness[nSecond] && nFirst < nSecond); }
+		const FITNESS_TYPE *pFitness;
+	};
+}
+
+fenn::Population::Population()
+{
+	Initialize();
+}
+
+fenn::Population::Population(const unsigned int nThreads)
+	: m_evaluator(nThreads)
+{
+	Initialize();
+}
+
+fenn::Population::~Population()
+{
+	//nothing to do
+}
+
+void fenn::Population::Create(const unsigned int nGenomes, const unsigned int nInput, const unsigned int nMaxHidden, const unsigned int nOutput)
+{
+	assert(nGenomes > 0);
+
+	//all genomes share the indices of their input and output neurons, hence they are copies of
+	//the same RNA string. Every copy owns its memory, such that it can be recycled
+	std::vector<RNA> &veGenomes = m_pveGenerations[0];
+	veGenomes.resize(nGenomes);
+	veGenomes[0].Create(nInput, nMaxHidden, nOutput);
+
+	for (unsigned int i = 1; i < nGenomes; i++) {
+		veGenomes[i].Create(veGenomes[0]);
+	}
+
+	//the other generation is created when reproducing
+	m_pveGenerations[1].resize(nGenomes);
+	m_pveFitness[0].assign(nGenomes, FITNESS_DEFAULT);
+	m_pveFitness[1].assign(nGenomes, FITNESS_DEFAULT);
+	m_veRanking.resize(nGenomes);
+	m_nGeneration = 0;
+	m_bEvaluated = false;
+	m_speciation.Clear();
+	SetCurrentGeneration(0);
+}
+
+void fenn::Population::SetMutationRates(const RNAMutationRates &rates)
+{
+	m_rates = rates;
+}
+
+void fenn::Population::SetNumElites(const unsigned int nElites)
+{
+	m_nNumElites = nElites;
+}
+
+void fenn::Population::SetTournamentSize(const unsigned int nSize)
+{
+	assert(nSize > 0);
+	m_nTournamentSize = nSize;
+}
+
+fenn::PopulationEvaluator& fenn::Population::GetEvaluator()
+{
+	return m_evaluator;
+}
+
+fenn::Speciation& fenn::Population::GetSpeciation()
+{
+	return m_speciation;
+}
+
+void fenn::Population::Evaluate(const PopulationEvaluator::FUNCTION_FITNESS &fitness)
+{
+	m_evaluator.Evaluate(m_veGenomes.data(), m_veGenomes.size(), m_pveFitness[m_nCurrent].data(), fitness);
+	m_bEvaluated = true;
+}
+
+void fenn::Population::Reproduce()
+{
+	ProduceGeneration(NULL);
+}
+
+void fenn::Population::Reproduce(const PopulationEvaluator::FUNCTION_FITNESS &fitness)
+{
+	ProduceGeneration(&fitness);
+}
+
+unsigned int fenn::Population::GetNumGenomes() const
+{
+	return m_veGenomes.size();
+}
+
+unsigned int fenn::Population::GetGeneration() const
+{
+	return m_nGeneration;
+}
+
+const fenn::RNA& fenn::Population::GetGenome(const unsigned int iGenome) const
+{
+	assert(iGenome < m_veGenomes.size());
+	return *m_veGenomes[iGenome];
+}
+
+const fenn::RNA * const * fenn::Population::GetGenomes() const
+{
+	return m_veGenomes.data();
+}
+
+FITNESS_TYPE fenn::Population::GetFitness(const unsigned int iGenome) const
+{
+	assert(iGenome < m_pveFitness[m_nCurrent].size());
+	return m_pveFitness[m_nCurrent][iGenome];
+}
+
+const FITNESS_TYPE* fenn::Population::GetFitnesses() const
+{
+	return m_pveFitness[m_nCurrent].data();
+}
+
+unsigned int fenn::Population::GetChampion() const
+{
+	//the genome with the highest fitness
+	const std::vector<FITNESS_TYPE> &veFitness = m_pveFitness[m_nCurrent];
+	assert(!veFitness.empty());
+	return std::max_element(veFitness.begin(), veFitness.end()) - veFitness.begin();
+}
+
+void fenn::Population::Initialize()
+{
+	m_rates = RNAMutationRates();
+	m_nNumElites = POPULATION_ELITES;
+	m_nTournamentSize = POPULATION_TOURNAMENT_SIZE;
+	m_nCurrent = 0;
+	m_nGeneration = 0;
+	m_bEvaluated = false;
+	m_nSeed = 0;
+	m_pFitness = NULL;
+}
+
+void fenn::Population::SetCurrentGeneration(const unsigned int nCurrent)
+{
+	//the pointers are passed to the evaluator and speciation
+	m_nCurrent = nCurrent;
+	m_veGenomes.resize(m_pveGenerations[nCurrent].size());
+
+	for (unsigned int i = 0; i < m_veGenomes.size(); i++) {
+		m_veGenomes[i] = &m_pveGenerations[nCurrent][i];
+	}
+}
+
+void fenn::Population::ProduceGeneration(const PopulationEvaluator::FUNCTION_FITNESS *pFitness)
+{
+	assert(m_bEvaluated && !m_veGenomes.empty());
+	const unsigned int nGenomes = m_veGenomes.size();
+	const FITNESS_TYPE* const pParentFitness = m_pveFitness[m_nCurrent].data();
+
+	//divide the parents into species, the second parent of every child is selected from the
+	//species of the first parent
+	m_speciation.Speciate(m_veGenomes.data(), nGenomes, m_evaluator.GetScheduler());
+
+	//rank the parents, only the elites have to be sorted
+	const unsigned int nElites = std::min(m_nNumElites, nGenomes);
+
+	for (unsigned int i = 0; i < nGenomes; i++) {
+		m_veRanking[i] = i;
+	}
+
+	std::partial_sort(m_veRanking.begin(), m_veRanking.begin() + nElites, m_veRanking.end(), CompareFitness(pParentFitness));
+
+	//produce the children in the other generation. The seed of the random streams of the
+	//children is drawn by the calling thread
+	m_innovations.Reset();
+	m_nSeed = GetThreadRandomEngine().Next();
+	m_pFitness = pFitness;
+
+	m_evaluator.GetScheduler().Run(nGenomes, [this](const comt::TaskScheduler::Task &task, const unsigned int iThread) {
+		RunTask(task, iThread);
+	});
+
+	m_pFitness = NULL;
+
+	//the children become the current generation, the parents are recycled next generation
+	SetCurrentGeneration(1 - m_nCurrent);
+	m_nGeneration++;
+	m_bEvaluated = pFitness != NULL;
+}
+
+void fenn::Population::RunTask(const comt::TaskScheduler::Task &task, const unsigned int iThread)
+{
+	const unsigned int iChild = task.nItem;
+
+	if (task.nStage == CHILDSTAGE_PRODUCE) {
+		ProduceChild(iChild);
+
+		//the evaluation is pushed to the front of the deque of this thread, hence it usually follows
+		//right away while the child is still in the cache. Idle threads steal the oldest tasks
+		if (m_pFitness != NULL) {
+			const comt::TaskScheduler::Task evaluate = { iChild, CHILDSTAGE_EVALUATE };
+			m_evaluator.GetScheduler().Spawn(evaluate, iThread);
+		}
+	} else {
+		assert(task.nStage == CHILDSTAGE_EVALUATE && m_pFitness != NULL);
+		const unsigned int nNext = 1 - m_nCurrent;
+		m_evaluator.EvaluateGenome(m_pveGenerations[nNext][iChild], iChild, m_pveFitness[nNext].data(), *m_pFitness, iThread);
+	}
+}
+
+void fenn::Population::ProduceChild(const unsigned int iChild)
+{
+	std::vector<RNA> &veParents = m_pveGenerations[m_nCurrent];
+	const std::vector<FITNESS_TYPE> &veFitness = m_pveFitness[m_nCurrent];
+	RNA &child = m_pveGenerations[1 - m_nCurrent][iChild];
+
+	//the elites are copied unchanged
+	if (iChild < m_nNumElites) {
+		child.Create(veParents[m_veRanking[iChild]]);
+		return;
+	}
+
+	//every child uses its own random stream, such that its random draws do not depend on the
+	//thread producing it. The indices of new genes still depend on the order of the threads
+	ScopedRandomStream stream(m_nSeed, iChild);
+
+	const unsigned int nFirst = SelectParent(NULL, veParents.size());
+	const Species &species = m_speciation.GetSpecies(m_speciation.GetGenomeSpecies(nFirst));
+	const unsigned int nSecond = SelectParent(species.veMembers.data(), species.veMembers.size());
+
+	if (nFirst == nSecond) {
+		child.Create(veParents[nFirst]);
+	} else if (veFitness[nFirst] >= veFitness[nSecond]) {
+		child.Create(&veParents[nFirst], &veParents[nSecond]);
+	} else {
+		child.Create(&veParents[nSecond], &veParents[nFirst]);
+	}
+
+	child.Mutate(m_rates, m_innovations);
+}
+
+unsigned int fenn::Population::SelectParent(const unsigned int *pCandidates, const unsigned int nCandidates) const
+{
+	//the fittest of a number of random candidates, the candidates are either the given genomes
+	//or all genomes when none are given
+	assert(nCandidates > 0);
+	const std::vector<FITNESS_TYPE> &veFitness = m_pveFitness[m_nCurrent];
+	unsigned int nBest = 0;
+
+	for (unsigned int i = 0; i < m_nTournamentSize; i++) {
+		const unsigned int nRandom = GetRandom(nCandidates);
+		const unsigned int nCandidate = pCandidates ? pCandidates[nRandom] : nRandom;
+
+		if (i == 0 || veFitness[nCandidate] > veFitness[nBest]) {
+			nBest = nCandidate;
+		}
+	}
+
+	return nBest;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef FENN_POPULATION_H
+#define FENN_POPULATION_H
+
+#include "FENNConfig.h"
+#include "FENNRNA.h"
+#include "FENNInnovation.h"
+#include "FENNEvaluator.h"
+#include "FENNSpecies.h"
+
+#include <COMTTaskScheduler.h>
+
+#include <vector>
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Class - Population
+	//----------------------------------------------------------------
+	// Drives the evolution of a population of RNA strings. The
+	// population owns two generations of RNA strings: the current
+	// generation, which is evaluated and from which the parents are
+	// selected, and the previous generation, whose RNA strings are
+	// recycled as the children of the next generation. Producing a
+	// child overwrites the RNA string in place, reusing its memory,
+	// after which both generations swap roles. Once the sizes of the
+	// RNA strings have settled, evolving the population therefore
+	// does not allocate any memory. The generations act as the pools
+	// from which the genes are drawn: every RNA string stores its
+	// neurons and connections in a few contiguous arrays without any
+	// allocation per gene, and a generation which is no longer needed
+	// is released as a whole, in constant time, by recycling it
+	// rather than by freeing its genes one by one.
+	// Reproducing divides the current generation into species, after
+	// which every child is produced as a separate task:
+	//		1. The elites, the fittest genomes, are copied unchanged.
+	//		2. The first parent is selected by a tournament among the
+	//			entire generation, the second by a tournament among
+	//			the species of the first parent.
+	//		3. The child is the recombination of both parents, with
+	//			the fitter parent as the champion. A genome selected
+	//			as both parents is copied instead.
+	//		4. The child is mutated.
+	// When a fitness function is passed to Reproduce(...), producing
+	// a child spawns a second task which compiles and evaluates the
+	// child. All tasks, including those dividing the generation into
+	// species, run on the work stealing scheduler of the evaluator,
+	// hence the population uses a single set of threads. Threads
+	// which are done with their own children take over the remaining
+	// tasks of threads that drew large genomes, without a barrier in
+	// between reproducing and evaluating. Every child draws its
+	// random numbers from its own stream, hence the random draws
+	// which select the parents and the mutations do not depend on the
+	// thread that produces the child. The global indices of new genes
+	// however are handed out by the innovation registry in the order
+	// in which the threads first register a mutation, hence the
+	// numbering of the genes, and thereby the order of the genes and
+	// the course of the evolution, still depends on the threads.
+	// The fitness function should assign higher values to better
+	// genomes, and can only access the child through the brain of
+	// the evaluation context.
+	//----------------------------------------------------------------
+	class Population
+	{
+	public:
+		//constructors and destructor
+		Population();
+		explicit Population(const unsigned int nThreads);
+		~Population();
+
+		//creating the first generation, copies of a RNA string connecting all its input neurons
+		//to all its output neurons
+		void Create(const unsigned int nGenomes, const unsigned int nInput, const unsigned int nMaxHidden, const unsigned int nOutput);
+
+		//setting how the next generation is produced
+		void SetMutationRates(const RNAMutationRates &rates);
+		void SetNumElites(const unsigned int nElites);
+		void SetTournamentSize(const unsigned int nSize);
+
+		//accessing the evaluator and the speciation, for example to set a fitness cache or the
+		//compatibility threshold
+		PopulationEvaluator& GetEvaluator();
+		Speciation& GetSpeciation();
+
+		//evaluating the current generation, and replacing it by the next generation. The next
+		//generation is either left unevaluated or evaluated while it is being produced
+		void Evaluate(const PopulationEvaluator::FUNCTION_FITNESS &fitness);
+		void Reproduce();
+		void Reproduce(const PopulationEvaluator::FUNCTION_FITNESS &fitness);
+
+		//inspecting the current generation
+		unsigned int GetNumGenomes() const;
+		unsigned int GetGeneration() const;
+		const RNA& GetGenome(const unsigned int iGenome) const;
+		const RNA * const * GetGenomes() const;
+		FITNESS_TYPE GetFitness(const unsigned int iGenome) const;
+		const FITNESS_TYPE* GetFitnesses() const;
+		unsigned int GetChampion() const;
+
+	protected:
+		//the components used to evolve the population
+		PopulationEvaluator			m_evaluator;
+		Speciation					m_speciation;
+		InnovationRegistry			m_innovations;
+
+		//the settings
+		RNAMutationRates			m_rates;
+		unsigned int				m_nNumElites;
+		unsigned int				m_nTournamentSize;
+
+		//both generations and their fitness, the current generation is m_pveGenerations[m_nCurrent].
+		//The pointers belong to the current generation
+		std::vector<RNA>			m_pveGenerations[2];
+		std::vector<FITNESS_TYPE>	m_pveFitness[2];
+		unsigned int				m_nCurrent;
+		unsigned int				m_nGeneration;
+		std::vector<const RNA*>		m_veGenomes;
+		bool						m_bEvaluated;
+
+		//workspace used while reproducing
+		std::vector<unsigned int>	m_veRanking;
+		unsigned long long			m_nSeed;
+		const PopulationEvaluator::FUNCTION_FITNESS *m_pFitness;
+
+	private:
+		Population(const Population &population);
+		void operator = (const Population &population);
+
+		void Initialize();
+		void SetCurrentGeneration(const unsigned int nCurrent);
+		void ProduceGeneration(const PopulationEvaluator::FUNCTION_FITNESS *pFitness);
+		void RunTask(const comt::TaskScheduler::Task &task, const unsigned int iThread);
+		void ProduceChild(const unsigned int iChild);
+		unsigned int SelectParent(const unsigned int *pCandidates, const unsigned int nCandidates) const;
+	};
+}
+
+#endif
\ No newline at end of file
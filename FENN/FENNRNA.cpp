@@ -1,901 +1,1747 @@
 #include "FENNRNA.h"
 #include "FENNRandom.h"
+#include "FENNStorage.h"
+#include "FENNHashTable.h"
 
 #include <cassert>
-#include <map>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
 
-fenn::ConnectionAllele::ConnectionAllele()
-	: nIndex(0)
-	, pParentNeuron(NULL)
-	, pConnectedNeuron(NULL)
-	, nConnectedSlot(0)
-	, fWeight(0)
+namespace
 {
-}
+	//the orders shared by all input and all output neurons, the hidden neurons are ordered in
+	//between. Hidden neurons removed while mutating are marked until the arrays are compacted
+	const unsigned int ORDER_INPUT = 0;
+	const unsigned int ORDER_OUTPUT = ~0u;
+	const unsigned int ORDER_REMOVED = ~0u - 1;
+
+	//the identification and version of the binary format, and the number of bits used to store
+	//a neuron type and a connection slot
+	const unsigned char STORAGE_MAGIC[4] = { 'F', 'R', 'N', 'A' };
+	const unsigned char STORAGE_VERSION = 1;
+	const unsigned int STORAGE_NEURONTYPE_BITS = 3;
+	const unsigned int STORAGE_SLOT_BITS = 1;
+
+	static_assert(fenn::NEURONTYPE_UNKNOWN < (1 << STORAGE_NEURONTYPE_BITS), "neuron types do not fit the binary format");
+	static_assert(SLOT_MAX < (1 << STORAGE_SLOT_BITS), "connection slots do not fit the binary format");
+
+	//the RNA copies its alleles as plain memory
+	static_assert(std::is_trivially_copyable<fenn::NeuronAllele>::value, "neuron alleles should be trivially copyable");
+	static_assert(std::is_trivially_copyable<fenn::ConnectionAllele>::value, "connection alleles should be trivially copyable");
+
+	//the connections make up most of an RNA string, they should not be padded any further
+	static_assert(sizeof(fenn::ConnectionAllele) <= 12, "connection alleles should remain packed");
+
+	//the name of every neuron without a name
+	const std::string NAME_EMPTY;
+
+	struct CompareNeuronOrder {
+		explicit CompareNeuronOrder(const fenn::NeuronAllele *pNeurons) : pNeurons(pNeurons) {}
+		bool operator () (const LOCAL_INDEX_TYPE nFirst, const LOCAL_INDEX_TYPE nSecond) const { return pNeurons[nFirst].nOrder < pNeurons[nSecond].nOrder; }
+		const fenn::NeuronAllele *pNeurons;
+	};
+
+	//the order of the neuron a new neuron connects to, new neurons only have a single connection
+	inline unsigned int GetTargetOrder(const fenn::NeuronAllele *pNeurons, const fenn::ConnectionAllele *pConnections, const LOCAL_INDEX_TYPE nNew)
+	{
+		return pNeurons[pConnections[pNeurons[nNew].nFirstConnection].nConnectedNeuron].nOrder;
+	}
 
-fenn::ConnectionAllele::ConnectionAllele(const ConnectionAllele &allele)
-	: nIndex(allele.nIndex)
-	, pParentNeuron(allele.pParentNeuron)
-	, pConnectedNeuron(allele.pConnectedNeuron)
-	, nConnectedSlot(allele.nConnectedSlot)
-	, fWeight(allele.fWeight)
-{
-}
+	struct CompareTargetOrder {
+		CompareTargetOrder(const fenn::NeuronAllele *pNeurons, const fenn::ConnectionAllele *pConnections) : pNeurons(pNeurons), pConnections(pConnections) {}
+		bool operator () (const LOCAL_INDEX_TYPE nFirst, const LOCAL_INDEX_TYPE nSecond) const {
+			const unsigned int nFirstOrder = GetTargetOrder(pNeurons, pConnections, nFirst);
+			const unsigned int nSecondOrder = GetTargetOrder(pNeurons, pConnections, nSecond);
+			return nFirstOrder < nSecondOrder || (nFirstOrder == nSecondOrder && nFirst < nSecond);
+		}
+		const fenn::NeuronAllele *pNeurons;
+		const fenn::ConnectionAllele *pConnections;
+	};
+
+	struct CompareNeuronIndex {
+		explicit CompareNeuronIndex(const fenn::NeuronAllele *pNeurons) : pNeurons(pNeurons) {}
+		bool operator () (const LOCAL_INDEX_TYPE nFirst, const LOCAL_INDEX_TYPE nSecond) const { return pNeurons[nFirst].nIndex < pNeurons[nSecond].nIndex; }
+		const fenn::NeuronAllele *pNeurons;
+	};
+
+	inline bool CompareConnectionIndex(const fenn::ConnectionAllele &first, const fenn::ConnectionAllele &second)
+	{
+		return first.nIndex < second.nIndex;
+	}
 
-void fenn::ConnectionAllele::operator = (const ConnectionAllele &allele)
-{
-	//simply copy all information from the passed allele argument
-	nIndex				= allele.nIndex;
-	pParentNeuron		= allele.pParentNeuron;
-	pConnectedNeuron	= allele.pConnectedNeuron;
-	nConnectedSlot		= allele.nConnectedSlot;
-	fWeight				= allele.fWeight;
+	inline bool CompareConnectionToIndex(const fenn::ConnectionAllele &connection, const GLOBAL_INDEX_TYPE nIndex)
+	{
+		return connection.nIndex < nIndex;
+	}
+
+	inline bool CompareNameToIndex(const std::pair<GLOBAL_INDEX_TYPE, std::string> &name, const GLOBAL_INDEX_TYPE nIndex)
+	{
+		return name.first < nIndex;
+	}
+
+	inline bool CompareNameIndex(const std::pair<GLOBAL_INDEX_TYPE, std::string> &first, const std::pair<GLOBAL_INDEX_TYPE, std::string> &second)
+	{
+		return first.first < second.first;
+	}
+
+	inline unsigned long long GetValueBits(const float fValue)
+	{
+		unsigned int nBits;
+		memcpy(&nBits, &fValue, sizeof(nBits));
+		return nBits;
+	}
+
+	//the hash of an RNA string is the sum of the hashes of its genes, such that it does not
+	//depend on the order of the genes and can be updated whenever a single gene changes
+	inline unsigned long long HashNeuronGene(const fenn::NeuronAllele &neuron, const BIAS_TYPE fBias)
+	{
+		return fenn::MixHash(fenn::MixHash(((unsigned long long)neuron.nIndex << 32) | (unsigned long long)neuron.eNeuronType) ^ GetValueBits(fBias));
+	}
+
+	inline unsigned long long HashConnectionGene(const fenn::ConnectionAllele &connection, const WEIGHT_TYPE fWeight)
+	{
+		//connection indices are never shared by different pairs of neurons, hence the index
+		//identifies both neurons. The constant separates connection from neuron genes
+		return fenn::MixHash(fenn::MixHash(((unsigned long long)connection.nIndex << 32) | (unsigned long long)connection.nConnectedSlot) ^ (GetValueBits(fWeight) << 32) ^ 0x9E3779B97F4A7C15ULL);
+	}
+
+	//apply the values to the parameters at the given (increasing) positions. When every
+	//parameter mutates the positions are not needed, such that the loop can be vectorized
+	template <class T> void ReplaceParameters(T *pParameters, const unsigned int nCount, const unsigned int *pPositions, const float *pValues, const unsigned int nValues)
+	{
+		if (nValues == nCount) {
+			for (unsigned int i = 0; i < nCount; i++) {
+				pParameters[i] = (T)pValues[i];
+			}
+		} else {
+			for (unsigned int i = 0; i < nValues; i++) {
+				pParameters[pPositions[i]] = (T)pValues[i];
+			}
+		}
+	}
+
+	template <class T> void AddParameters(T *pParameters, const unsigned int nCount, const unsigned int *pPositions, const float *pValues, const unsigned int nValues)
+	{
+		if (nValues == nCount) {
+			for (unsigned int i = 0; i < nCount; i++) {
+				pParameters[i] += (T)pValues[i];
+			}
+		} else {
+			for (unsigned int i = 0; i < nValues; i++) {
+				pParameters[pPositions[i]] += (T)pValues[i];
+			}
+		}
+	}
 }
 
-fenn::ConnectionAllele::~ConnectionAllele()
+fenn::ConnectionAllele::ConnectionAllele()
+	: nIndex(0)
+	, nConnectedNeuron(0)
+	, nConnectedSlot(0)
 {
-	//nothing to do
 }
 
 fenn::NeuronAllele::NeuronAllele()
 	: nIndex(0)
 	, eNeuronType(NEURONTYPE_UNKNOWN)
-	, fBias(0)
+	, nFirstConnection(0)
+	, nNumConnections(0)
+	, nMaxConnections(0)
+	, nOrder(ORDER_INPUT)
+{
+}
+
+fenn::RNAMutationSamplers::RNAMutationSamplers(const RNAMutationRates &rates)
+	: mappingFunction(rates.fMappingFunction, rates.eSampling)
+	, addNeuron(rates.fAddNeuron, rates.eSampling)
+	, removeNeuron(rates.fRemoveNeuron, rates.eSampling)
+	, neuronSlot(rates.fNeuronSlot, rates.eSampling)
+	, biasRandom(rates.fBiasRandom, rates.eSampling)
+	, biasAdditive(rates.fBiasAdditive, rates.eSampling)
+	, addConnection(rates.fAddConnection, rates.eSampling)
+	, weightRandom(rates.fWeightRandom, rates.eSampling)
+	, weightAdditive(rates.fWeightAdditive, rates.eSampling)
 {
 }
 
-fenn::NeuronAllele::NeuronAllele(const NeuronAllele &allele)
-	: sName(allele.sName)
-	, nIndex(allele.nIndex)
-	, eNeuronType(allele.eNeuronType)
-	, fBias(allele.fBias)
-	, veConnections(allele.veConnections)
-	, veConnected(allele.veConnected)
-	, setAllConnected(allele.setAllConnected)
+fenn::RNAMutationPlan::RNAMutationPlan()
+	: rates()
+	, nNumNeurons(0)
+	, nHash(0)
 {
 }
 
-void fenn::NeuronAllele::operator = (const NeuronAllele &allele)
+fenn::RNA::Topology::Topology()
+	: nNumConnections(0)
 {
-	sName			= allele.sName;
-	nIndex			= allele.nIndex;
-	eNeuronType		= allele.eNeuronType;
-	fBias			= allele.fBias;
-	veConnections	= allele.veConnections;
-	veConnected		= allele.veConnected;
-	setAllConnected = allele.setAllConnected;
 }
 
 fenn::RNA::RNA()
 	: m_nMaxNumHiddenNeurons(0)
+	, m_nNumInputNeurons(0)
+	, m_nNumOutputNeurons(0)
+	, m_pTopology(std::make_shared<Topology>())
+	, m_pParameters(std::make_shared<Parameters>())
+	, m_nHash(0)
+	, m_nVisit(0)
 {
 }
 
 fenn::RNA::RNA(const RNA &rna)
+	: m_nMaxNumHiddenNeurons(rna.m_nMaxNumHiddenNeurons)
+	, m_nNumInputNeurons(rna.m_nNumInputNeurons)
+	, m_nNumOutputNeurons(rna.m_nNumOutputNeurons)
+	, m_pTopology(rna.m_pTopology)
+	, m_pParameters(rna.m_pParameters)
+	, m_nHash(rna.m_nHash)
+	, m_nVisit(0)
 {
-	//call the assignment operator function
-	*this = rna;
 }
 
-void fenn::RNA::operator = (const RNA &rna) 
+fenn::RNA::RNA(RNA &&rna) FENN_NOEXCEPT
+	: m_nMaxNumHiddenNeurons(0)
+	, m_nNumInputNeurons(0)
+	, m_nNumOutputNeurons(0)
+	, m_nHash(0)
+	, m_nVisit(0)
 {
-	//delete any previously allocated data
-	ReleaseAll();
-
-	//copy simple variables
-	m_nMaxNumHiddenNeurons = rna.m_nMaxNumHiddenNeurons;
-
-	//reserve size for all neurons
-	m_veInputNeurons.reserve(rna.m_veInputNeurons.size());
-	m_veHiddenNeurons.reserve(rna.m_veHiddenNeurons.size());
-	m_veOutputNeurons.reserve(rna.m_veOutputNeurons.size());
-
-	//copy all neurons and create a map such that the connections can be recreated as well
-	std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> map;
-
-	for (const auto pNeuron : rna.m_veInputNeurons) {
-		NeuronAllele *pNew = CreateNeuronAllele(*pNeuron);
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNew->nIndex, pNew));
-		m_veInputNeurons.push_back(pNew);
-	}
-
-	for (const auto pNeuron : rna.m_veHiddenNeurons) {
-		NeuronAllele *pNew = CreateNeuronAllele(*pNeuron);
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNew->nIndex, pNew));
-		m_veHiddenNeurons.push_back(pNew);
-	}
+	//take over the blocks and the workspace, the other RNA string is left without blocks
+	*this = std::move(rna);
+}
 
-	for (const auto pNeuron : rna.m_veOutputNeurons) {
-		NeuronAllele *pNew = CreateNeuronAllele(*pNeuron);
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNew->nIndex, pNew));
-		m_veOutputNeurons.push_back(pNew);
+void fenn::RNA::operator = (const RNA &rna)
+{
+	if (this == &rna) {
+		return;
 	}
 
-	//now create the connections
-	auto it = rna.m_veInputNeurons.cbegin();
-	for (const auto pNeuron : m_veInputNeurons) {
-		CreateNeuronAlleleConnections(pNeuron, *it, map);
-		++it;
-	}
+	//the blocks are shared with the other RNA string, they are copied once either of the two
+	//changes them. The workspace is not copied, it is sized when mutating
+	m_nMaxNumHiddenNeurons	= rna.m_nMaxNumHiddenNeurons;
+	m_nNumInputNeurons		= rna.m_nNumInputNeurons;
+	m_nNumOutputNeurons		= rna.m_nNumOutputNeurons;
+	m_pTopology				= rna.m_pTopology;
+	m_pParameters			= rna.m_pParameters;
+	m_nHash					= rna.m_nHash;
+}
 
-	it = rna.m_veHiddenNeurons.cbegin();
-	for (const auto pNeuron : m_veHiddenNeurons) {
-		CreateNeuronAlleleConnections(pNeuron, *it, map);
-		++it;
+void fenn::RNA::operator = (RNA &&rna) FENN_NOEXCEPT
+{
+	if (this == &rna) {
+		return;
 	}
 
-	//now create the connection sets
-	for (const auto pNeuron : m_veOutputNeurons) {
-		CreateNeuronConnectionSets(pNeuron, NULL);
-	}
+	//swap the contents, such that the memory of this RNA string is reused by the other one
+	//instead of being released. The search lists are only workspace, they are left in place
+	std::swap(m_nMaxNumHiddenNeurons, rna.m_nMaxNumHiddenNeurons);
+	std::swap(m_nNumInputNeurons, rna.m_nNumInputNeurons);
+	std::swap(m_nNumOutputNeurons, rna.m_nNumOutputNeurons);
+	m_pTopology.swap(rna.m_pTopology);
+	m_pParameters.swap(rna.m_pParameters);
+	std::swap(m_nHash, rna.m_nHash);
+
+	m_veVisits.swap(rna.m_veVisits);
+	std::swap(m_nVisit, rna.m_nVisit);
+	m_veSearchStack.swap(rna.m_veSearchStack);
+	m_veSearchOrders.swap(rna.m_veSearchOrders);
+	m_plan.veAddConnections.swap(rna.m_plan.veAddConnections);
+	m_plan.veAddNeurons.swap(rna.m_plan.veAddNeurons);
+	m_plan.veRemoveNeurons.swap(rna.m_plan.veRemoveNeurons);
+	m_veCompactNeurons.swap(rna.m_veCompactNeurons);
+	m_veCompactConnections.swap(rna.m_veCompactConnections);
+	m_veCompactIndices.swap(rna.m_veCompactIndices);
+	m_veCompactBiases.swap(rna.m_veCompactBiases);
+	m_veCompactWeights.swap(rna.m_veCompactWeights);
+	m_veMutations.swap(rna.m_veMutations);
+	m_veMutationValues.swap(rna.m_veMutationValues);
 }
 
 fenn::RNA::~RNA()
 {
-	//delete all data contained in the vectors
-	ReleaseAll();
+	//nothing to do, the blocks are released once no RNA string shares them anymore
 }
 
 unsigned int fenn::RNA::GetStorageSize() const
 {
-	//TODO: Write this such that it returns the size needed to store data in a bitstring
-	//in bytes
-	return 0;
+	//a writer without data only counts the number of bytes
+	StorageWriter writer;
+	WriteStorage(writer);
+	return writer.GetSize();
 }
 
-void fenn::RNA::Create(const unsigned int nInput, const unsigned int nMaxHidden, const unsigned int nOutput)
+bool fenn::RNA::Save(unsigned char *pData, unsigned int nMax, unsigned int *pSize) const
 {
-	//resize the vectors such that the new neurons will fit
-	ResizeNeuronVector(m_veInputNeurons, nInput);
+	//when the data does not fit the writer stops writing and becomes invalid
+	StorageWriter writer(pData, nMax);
+	WriteStorage(writer);
 
-	for (auto neuron : m_veHiddenNeurons) {
-		ReleaseNeuronAllele(neuron);
+	if (pSize) {
+		*pSize = writer.IsValid() ? writer.GetSize() : 0;
 	}
-	m_veHiddenNeurons.clear();
 
-	ResizeNeuronVector(m_veOutputNeurons, nOutput);
+	return writer.IsValid();
+}
+
+bool fenn::RNA::Load(const unsigned char *pData, const unsigned int nSize)
+{
+	StorageReader reader(pData, nSize);
+
+	if (!ReadStorage(reader) || !reader.IsValid() || reader.GetRemaining() != 0 || !RebuildEdgeIndex()) {
+		//never leave a partially loaded RNA behind
+		Clear();
+		return false;
+	}
+
+	m_nHash = ComputeHash();
+	return true;
+}
+
+void fenn::RNA::Create(const unsigned int nInput, const unsigned int nMaxHidden, const unsigned int nOutput)
+{
+	m_nMaxNumHiddenNeurons = nMaxHidden;
+
+	//every input neuron is connected to every output neuron, there are no hidden neurons
+	Resize(nInput, nOutput, 0);
+	m_pTopology->veConnections.resize(nInput * nOutput);
+	m_pTopology->nNumConnections = nInput * nOutput;
+	m_pParameters->veBiases.assign(nInput + nOutput, BIAS_DEFAULT);
+	m_pParameters->veWeights.assign(nInput * nOutput, WEIGHT_DEFAULT);
+	m_pTopology->veNames.clear();
+	m_pTopology->veTopologicalOrder.clear();
 
 	//loop through the output neurons and set their values to default
 	//values
-	for (auto pNeuron : m_veOutputNeurons) {
-		pNeuron->nIndex = world_single::Get().GetNewNeuronIndex();
-		pNeuron->eNeuronType = NEURONTYPE_ADDITION;
-		pNeuron->fBias = BIAS_DEFAULT;
+	for (unsigned int i = 0; i < nOutput; i++) {
+		NeuronAllele &neuron = m_pTopology->veNeurons[nInput + i];
+		neuron.nIndex			= world_single::Get().GetNewNeuronIndex();
+		neuron.eNeuronType		= NEURONTYPE_ADDITION;
+		neuron.nFirstConnection	= 0;
+		neuron.nNumConnections	= 0;
+		neuron.nMaxConnections	= 0;
+		neuron.nOrder			= ORDER_OUTPUT;
 	}
 
 	//loop through the input neurons and set their values to default
 	//values
-	for (auto pNeuron : m_veInputNeurons) {
-		pNeuron->nIndex = world_single::Get().GetNewNeuronIndex();
-		pNeuron->eNeuronType = NEURONTYPE_ADDITION;
-		pNeuron->fBias = BIAS_DEFAULT;
+	for (unsigned int i = 0; i < nInput; i++) {
+		NeuronAllele &neuron = m_pTopology->veNeurons[i];
+		neuron.nIndex			= world_single::Get().GetNewNeuronIndex();
+		neuron.eNeuronType		= NEURONTYPE_ADDITION;
+		neuron.nFirstConnection	= i * nOutput;
+		neuron.nNumConnections	= nOutput;
+		neuron.nMaxConnections	= nOutput;
+		neuron.nOrder			= ORDER_INPUT;
 
 		//loop through all output neurons and connect this input neuron
 		//to all output neurons in the following loop
-		for (auto pOutput : m_veOutputNeurons) {
-			ConnectionAllele newConnection;
+		for (unsigned int j = 0; j < nOutput; j++) {
+			ConnectionAllele &newConnection = m_pTopology->veConnections[neuron.nFirstConnection + j];
 			newConnection.nIndex			= world_single::Get().GetNewConnectionIndex();
-			newConnection.pParentNeuron		= pNeuron;
-			newConnection.pConnectedNeuron	= pOutput;
+			newConnection.nConnectedNeuron	= (LOCAL_INDEX_TYPE)(nInput + j);
 			newConnection.nConnectedSlot	= SLOT_DEFAULT;
-			newConnection.fWeight			= WEIGHT_DEFAULT;
-
-			pNeuron->veConnections.push_back(newConnection);
-			pOutput->veConnected.push_back(pNeuron);
-			pNeuron->setAllConnected.insert(pOutput);
 		}
+
+		//keep the connections sorted by their index, all weights are the same
+		ConnectionAllele* const pFirst = m_pTopology->veConnections.data() + neuron.nFirstConnection;
+		std::sort(pFirst, pFirst + nOutput, CompareConnectionIndex);
 	}
+
+	m_nHash = ComputeHash();
+	RebuildEdgeIndex();
+}
+
+void fenn::RNA::Create(const RNA &rna)
+{
+	if (&rna == this) {
+		return;
+	}
+
+	//the blocks are only replaced when shared, otherwise their memory is reused by the copy
+	UnshareTopology(false);
+	UnshareParameters(false);
+
+	m_nMaxNumHiddenNeurons	= rna.m_nMaxNumHiddenNeurons;
+	m_nNumInputNeurons		= rna.m_nNumInputNeurons;
+	m_nNumOutputNeurons		= rna.m_nNumOutputNeurons;
+	*m_pTopology			= *rna.m_pTopology;
+	*m_pParameters			= *rna.m_pParameters;
+	m_nHash					= rna.m_nHash;
+	m_veVisits.resize(m_pTopology->veNeurons.size());
 }
 
 void fenn::RNA::Create(RNA* const pParentChampion, RNA* const pParent)
 {
 	//assert that the parent neurons are of expectedly similar sizes
-	assert(pParentChampion->m_veInputNeurons.size() == pParent->m_veInputNeurons.size());
+	assert(pParentChampion->m_nNumInputNeurons == pParent->m_nNumInputNeurons);
 	assert(pParentChampion->m_nMaxNumHiddenNeurons == pParent->m_nMaxNumHiddenNeurons);
-	assert(pParentChampion->m_veOutputNeurons.size() == pParent->m_veOutputNeurons.size());
-
-	//now ensure that the current neuron will be large enough to store all data.
-	ResizeNeuronVector(m_veInputNeurons, pParentChampion->m_veInputNeurons.size());
-	ResizeNeuronVector(m_veHiddenNeurons, pParentChampion->m_veHiddenNeurons.size());
-	ResizeNeuronVector(m_veOutputNeurons, pParentChampion->m_veOutputNeurons.size());
-	
-	//create neurons following the RNA recombining process. Create a map at the 
-	//same time to be able to relate the new neurons to the old ones. This map will
-	//be used later, when interconnecting the neurons
-	std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> map;
-
-	//create the input neurons
-	auto itNeuronChampion = pParentChampion->m_veInputNeurons.cbegin();
-	auto itNeuron = pParent->m_veInputNeurons.cbegin();
-
-	for (auto pNeuron : m_veInputNeurons) {
+	assert(pParentChampion->m_nNumOutputNeurons == pParent->m_nNumOutputNeurons);
+	assert(pParentChampion != this && pParent != this);
+
+	const RNA &champion = *pParentChampion;
+	const RNA &parent = *pParent;
+
+	//The new RNA inherits the structure of the champion, hence its neurons are laid out exactly
+	//like those of the champion, including their topological order, and the connections may
+	//refer to the local indices of the champion's neurons. The genes of both parents are sorted
+	//by their indices, such that matching genes are found in a single merge pass over both
+	//parents. The connections are recreated as consecutive ranges.
+	UnshareTopology(false);
+	UnshareParameters(false);
+
+	m_nMaxNumHiddenNeurons				= champion.m_nMaxNumHiddenNeurons;
+	m_nNumInputNeurons					= champion.m_nNumInputNeurons;
+	m_nNumOutputNeurons					= champion.m_nNumOutputNeurons;
+	m_pTopology->veNeurons				= champion.m_pTopology->veNeurons;
+	m_pParameters->veBiases				= champion.m_pParameters->veBiases;
+	m_pTopology->veNames				= champion.m_pTopology->veNames;
+	m_pTopology->veTopologicalOrder		= champion.m_pTopology->veTopologicalOrder;
+
+	m_pTopology->veConnections.clear();
+	m_pTopology->veConnections.reserve(champion.m_pTopology->nNumConnections);
+	m_pParameters->veWeights.clear();
+	m_pParameters->veWeights.reserve(champion.m_pTopology->nNumConnections);
+
+	for (unsigned int i = 0; i < GetFirstHiddenNeuron(); i++) {
 		//assert the indices of the neurons are the same, this ensures the RNA class
 		//is properly used according to the guidelines of the FENN framework
-		assert((*itNeuronChampion)->nIndex == (*itNeuron)->nIndex);
-		RecombineNeuronAllele(pNeuron, *itNeuronChampion, *itNeuron);
+		assert(champion.m_pTopology->veNeurons[i].nIndex == parent.m_pTopology->veNeurons[i].nIndex);
+		RecombineNeuronAllele(i, champion, parent, i);
+		RecombineNeuronAlleleConnections(i, champion, champion.m_pTopology->veNeurons[i], parent, &parent.m_pTopology->veNeurons[i]);
+	}
+
+	unsigned int iParent = parent.GetFirstHiddenNeuron();
 
-		//add the newly created neuron to the map
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNeuron->nIndex, pNeuron));
+	for (unsigned int i = GetFirstHiddenNeuron(); i < m_pTopology->veNeurons.size(); i++) {
+		const NeuronAllele &championNeuron = champion.m_pTopology->veNeurons[i];
 
-		//increment the parent iterators
-		++itNeuronChampion;
-		++itNeuron;
+		//look for the neuron with a matching index in the other parent
+		while (iParent < parent.m_pTopology->veNeurons.size() && parent.m_pTopology->veNeurons[iParent].nIndex < championNeuron.nIndex) {
+			iParent++;
+		}
+
+		if (iParent < parent.m_pTopology->veNeurons.size() && parent.m_pTopology->veNeurons[iParent].nIndex == championNeuron.nIndex) {
+			//matching neuron was found, make a new neuron allele by recombining the
+			//RNA from both parents
+			RecombineNeuronAllele(i, champion, parent, iParent);
+			RecombineNeuronAlleleConnections(i, champion, championNeuron, parent, &parent.m_pTopology->veNeurons[iParent]);
+		} else {
+			//no matching neuron found, the neuron already is a copy of the champion RNA's neuron
+			//allele
+			RecombineNeuronAlleleConnections(i, champion, championNeuron, parent, NULL);
+		}
 	}
 
-	//create the hidden neurons
-	itNeuronChampion = pParentChampion->m_veHiddenNeurons.cbegin();
-	auto itNeuronOld = pParent->m_veHiddenNeurons.cbegin();
-	
-	for (auto pNeuron : m_veHiddenNeurons) {
-		//find the neuron corresponding to the position the iterator of the champion
-		//parent is pointing to in the other parent's alleles
-		auto itNeuronNew = itNeuronOld;
+	m_pTopology->nNumConnections = m_pTopology->veConnections.size();
+	m_nHash = ComputeHash();
+	RebuildEdgeIndex();
+}
 
-		while (itNeuronNew < pParent->m_veHiddenNeurons.cend()) {
-			if ((*itNeuronNew)->nIndex == pNeuron->nIndex) {
-				//we found the matching neuron
-				break;
-			}
+void fenn::RNA::Mutate(const RNAMutationRates &rates, InnovationRegistry &innovations) {
+	//select all mutations first, such that they can be performed in a single pass. The plan is
+	//made for the current genes, hence it is always applied
+	PlanMutations(rates, m_plan);
+	ApplyMutations(m_plan, innovations);
+}
+
+void fenn::RNA::MutateParameters(const RNAMutationRates &rates)
+{
+	//only the properties of the existing neurons and connections are mutated, the structure
+	//remains compact and the rates of the structural mutations are ignored
+	RNAMutationSamplers samplers(rates);
+	MutateProperties(samplers);
+}
+
+void fenn::RNA::PlanMutations(const RNAMutationRates &rates, RNAMutationPlan &plan) const
+{
+	//every type of mutation is decided by its own sampler, in geometric mode these only draw
+	//random numbers for the genes which actually mutate. The samplers of the properties are
+	//only used when applying the plan
+	RNAMutationSamplers samplers(rates);
+	plan.rates = rates;
+	plan.nNumNeurons = m_pTopology->veNeurons.size();
+	plan.nHash = m_nHash;
+	plan.veAddConnections.clear();
+	plan.veAddNeurons.clear();
+	plan.veRemoveNeurons.clear();
+
+	//add connections, this is done on neurons which can be connected to something else. Hence
+	//it should occur on input and hidden neurons, which can possibly connect to hidden neurons
+	//and output neurons. The candidate connections form a grid of source neurons and target
+	//neurons. Instead of deciding for every candidate whether it is added, the number of
+	//candidates to skip until the next one that is added is drawn. Hence the cost scales with
+	//the number of added connections instead of the number of candidates
+	const unsigned long long nInputs = m_nNumInputNeurons;
+	const unsigned long long nHidden = GetNumHiddenNeurons();
+	const unsigned long long nTargets = nHidden + m_nNumOutputNeurons;
+	const unsigned long long nCandidates = (nInputs + nHidden) * nTargets;
+
+	unsigned long long iCandidate = samplers.addConnection.Skip(nCandidates);
+
+	while (iCandidate < nCandidates) {
+		const unsigned long long iSource = iCandidate / nTargets;
+		const unsigned long long iTarget = iCandidate % nTargets;
+
+		const unsigned int nSource = (unsigned int)(iSource < nInputs ? iSource : GetFirstHiddenNeuron() + (iSource - nInputs));
+		const unsigned int nTarget = (unsigned int)(iTarget < nHidden ? GetFirstHiddenNeuron() + iTarget : GetFirstOutputNeuron() + (iTarget - nHidden));
+
+		//only plan the connection if it doesn't exist yet, whether it creates a value loop
+		//depends on the connections added before it and is checked when applying
+		if (nSource != nTarget && !IsConnected(nSource, nTarget)) {
+			plan.veAddConnections.push_back(std::make_pair((LOCAL_INDEX_TYPE)nSource, (LOCAL_INDEX_TYPE)nTarget));
 		}
 
-		if (itNeuronNew != pParent->m_veHiddenNeurons.cend()) {
-			//matching neuron was found, make a new neuron allele by recombining the 
-			//RNA from both parents
-			RecombineNeuronAllele(pNeuron, *itNeuronChampion, *itNeuronNew);
+		//move to the next candidate to add, taking care not to overflow
+		const unsigned long long nSkip = samplers.addConnection.Skip(nCandidates - iCandidate - 1);
 
-			//because we found a matching neuron, continue searching for subsequently
-			//matching neurons from the current iteration point
-			itNeuronOld = itNeuronNew;
-			++itNeuronOld;
-		} else {
-			//no matching neuron found, simply copy the champion RNA's neuron allele
-			const NeuronAllele* const pChampion = *itNeuronChampion;
+		if (nSkip >= nCandidates - iCandidate - 1) {
+			break;
+		}
+
+		iCandidate += nSkip + 1;
+	}
 
-			pNeuron->sName		= pChampion->sName;
-			pNeuron->nIndex		= pChampion->nIndex;
-			pNeuron->eNeuronType = pChampion->eNeuronType;
-			pNeuron->fBias		= pChampion->fBias;
+	//add neurons, this is done on a connection. Hence the type of mutation should be applied
+	//both to the input neurons as the hidden neurons
+	for (unsigned int i = 0; i < GetFirstOutputNeuron(); i++) {
+		const ConnectionAllele* const pConnections = GetConnections(m_pTopology->veNeurons[i]);
+
+		for (unsigned int j = 0; j < m_pTopology->veNeurons[i].nNumConnections; j++) {
+			//check if this connection should be mutated
+			if (samplers.addNeuron.Sample()) {
+				plan.veAddNeurons.push_back(std::make_pair((LOCAL_INDEX_TYPE)i, pConnections[j].nIndex));
+			}
 		}
+	}
+
+	for (unsigned int i = GetFirstHiddenNeuron(); i < m_pTopology->veNeurons.size(); i++) {
+		const ConnectionAllele* const pConnections = GetConnections(m_pTopology->veNeurons[i]);
 
-		//whatever happened, the neuron has its proper description now,
-		//add it to the map and process the next one
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNeuron->nIndex, pNeuron));
-		++itNeuronChampion;
+		for (unsigned int j = 0; j < m_pTopology->veNeurons[i].nNumConnections; j++) {
+			//check if this connection should be mutated
+			if (samplers.addNeuron.Sample()) {
+				plan.veAddNeurons.push_back(std::make_pair((LOCAL_INDEX_TYPE)i, pConnections[j].nIndex));
+			}
+		}
 	}
 
-	//create the output neurons
-	itNeuronChampion = pParentChampion->m_veOutputNeurons.cbegin();
-	itNeuron = pParent->m_veOutputNeurons.cbegin();
+	//remove neurons. As this type of mutation should only occur on neurons which have both
+	//neurons connected to them as neurons to which they connect, this type of mutation should
+	//only occur on hidden neurons
+	for (unsigned int i = GetFirstHiddenNeuron(); i < m_pTopology->veNeurons.size(); i++) {
+		if (samplers.removeNeuron.Sample()) {
+			plan.veRemoveNeurons.push_back((LOCAL_INDEX_TYPE)i);
+		}
+	}
+}
 
-	for (auto pNeuron : m_veOutputNeurons) {
-		//ensure the neuron indices match to assert that the programmer using the FENN
-		//framework is using it in the correct fashion
-		assert((*itNeuronChampion)->nIndex == (*itNeuron)->nIndex);
+bool fenn::RNA::ApplyMutations(const RNAMutationPlan &plan, InnovationRegistry &innovations)
+{
+	//the plan refers to the neurons by their local index, hence it is only valid for the genes
+	//it was planned for. Any other plan is rejected without changing the RNA string
+	if (plan.nNumNeurons != m_pTopology->veNeurons.size() || plan.nHash != m_nHash) {
+		return false;
+	}
 
-		//recombine the neuron alleles to a new output neuron allele
-		RecombineNeuronAllele(pNeuron, *itNeuronChampion, *itNeuron);
+	RNAMutationSamplers samplers(plan.rates);
 
-		//add the new allele to the map
-		map.insert(std::pair<GLOBAL_INDEX_TYPE, NeuronAllele*>(pNeuron->nIndex, pNeuron));
+	//the structure is likely to change, hence neither block remains shared
+	UnshareTopology(true);
+	UnshareParameters(true);
+	m_veVisits.resize(m_pTopology->veNeurons.size());
 
-		//increment iterators
-		++itNeuronChampion;
-		++itNeuron;
+	//start by mutating all the relatively simple things, mapping functions, biases and weights
+	MutateProperties(samplers);
+
+	//add the planned connections that do not create a value loop, the check reorders the
+	//neurons if required
+	for (const auto &connection : plan.veAddConnections) {
+		if (OrderConnection(connection.first, connection.second)) {
+			MutateNeuronAlleleAddConnection(connection.first, connection.second, innovations);
+		}
 	}
 
-	//Now that the input, hidden and output neurons are created, create all the connections
-	//between them using the created map
-	itNeuronChampion = pParentChampion->m_veInputNeurons.cbegin();
-	itNeuron = pParent->m_veInputNeurons.cbegin();
+	//add the planned neurons, these are appended to the neurons and are only placed in the
+	//topological order once all of them have been added
+	const unsigned int nFirstNew = m_pTopology->veNeurons.size();
 
-	for (auto pNeuron : m_veInputNeurons) {
-		RecombineNeuronAlleleConnections(pNeuron, *itNeuronChampion, *itNeuron, map);
+	for (const auto &selected : plan.veAddNeurons) {
+		MutateConnectionAlleleAddNeuron(selected.first, selected.second, innovations);
+	}
+
+	InsertTopologicalOrder(nFirstNew);
 
-		++itNeuronChampion;
-		++itNeuron;
+	//remove the planned neurons. The removed neurons keep their place in the topological
+	//order until all of them have been removed, and keep their local index until the arrays
+	//are compacted
+	for (const auto nRemoved : plan.veRemoveNeurons) {
+		MutateNeuronAlleleRemoveNeuron(nRemoved, innovations);
 	}
 
-	itNeuronChampion = pParentChampion->m_veHiddenNeurons.cbegin();
-	itNeuron = pParent->m_veHiddenNeurons.cbegin();
+	RemoveTopologicalOrder(plan.veRemoveNeurons);
+
+	//remove the marked neurons, sort the new neurons and move the connections back together
+	Compact();
+	assert(m_nHash == ComputeHash());
+	return true;
+}
+
+unsigned int fenn::RNA::GetNumNeurons() const
+{
+	return m_pTopology->veNeurons.size();
+}
+
+unsigned int fenn::RNA::GetNumInputNeurons() const
+{
+	return m_nNumInputNeurons;
+}
+
+unsigned int fenn::RNA::GetNumOutputNeurons() const
+{
+	return m_nNumOutputNeurons;
+}
+
+unsigned int fenn::RNA::GetNumHiddenNeurons() const
+{
+	return m_pTopology->veNeurons.size() - m_nNumInputNeurons - m_nNumOutputNeurons;
+}
+
+unsigned int fenn::RNA::GetFirstOutputNeuron() const
+{
+	return m_nNumInputNeurons;
+}
+
+unsigned int fenn::RNA::GetFirstHiddenNeuron() const
+{
+	return m_nNumInputNeurons + m_nNumOutputNeurons;
+}
+
+const fenn::NeuronAllele& fenn::RNA::GetNeuron(const unsigned int nNeuron) const
+{
+	assert(nNeuron < m_pTopology->veNeurons.size());
+	return m_pTopology->veNeurons[nNeuron];
+}
+
+const fenn::ConnectionAllele* fenn::RNA::GetConnections(const NeuronAllele &neuron) const
+{
+	return m_pTopology->veConnections.data() + neuron.nFirstConnection;
+}
+
+const WEIGHT_TYPE* fenn::RNA::GetWeights(const NeuronAllele &neuron) const
+{
+	return m_pParameters->veWeights.data() + neuron.nFirstConnection;
+}
 
-	for (auto pNeuron : m_veHiddenNeurons) {
-		RecombineNeuronAlleleConnections(pNeuron, *itNeuronChampion, *itNeuron, map);
+const BIAS_TYPE* fenn::RNA::GetBiases() const
+{
+	return m_pParameters->veBiases.data();
+}
+
+unsigned long long fenn::RNA::GetHash() const
+{
+	return m_nHash;
+}
 
-		++itNeuronChampion;
-		++itNeuron;
+const std::string& fenn::RNA::GetNeuronName(const NeuronAllele &neuron) const
+{
+	//most neurons do not have a name
+	auto it = std::lower_bound(m_pTopology->veNames.begin(), m_pTopology->veNames.end(), neuron.nIndex, CompareNameToIndex);
+	return it != m_pTopology->veNames.end() && it->first == neuron.nIndex ? it->second : NAME_EMPTY;
+}
+
+void fenn::RNA::SetNeuronName(const unsigned int nNeuron, const std::string &sName)
+{
+	//only the neurons with a name are stored, sorted by their index
+	UnshareTopology(true);
+	const GLOBAL_INDEX_TYPE nIndex = GetNeuron(nNeuron).nIndex;
+	auto it = std::lower_bound(m_pTopology->veNames.begin(), m_pTopology->veNames.end(), nIndex, CompareNameToIndex);
+
+	if (it != m_pTopology->veNames.end() && it->first == nIndex) {
+		if (sName.empty()) {
+			m_pTopology->veNames.erase(it);
+		} else {
+			it->second = sName;
+		}
+	} else if (!sName.empty()) {
+		m_pTopology->veNames.insert(it, PAIR_INDEX_NAME(nIndex, sName));
 	}
 }
 
-void fenn::RNA::Mutate(const RNAMutationRates &rates, std::vector<NeuronMutation> &prevNeuron, std::vector<ConnectionMutation> &prevConnection) {
-	//start by mutating all the relatively simple things, mapping functions, biases and weights
-	for (auto &pHidden : m_veHiddenNeurons) {
-		MutateNeuronAlleleProperties(pHidden, rates);
+void fenn::RNA::UnshareTopology(const bool bKeep)
+{
+	//a block which is not shared can be changed directly. A shared block is left to the other
+	//RNA strings using it, this RNA string continues with its own copy
+	if (m_pTopology.use_count() != 1) {
+		m_pTopology = bKeep ? std::make_shared<Topology>(*m_pTopology) : std::make_shared<Topology>();
 	}
+}
 
-	for (auto &pOutput : m_veOutputNeurons) {
-		MutateNeuronAlleleProperties(pOutput, rates);
+void fenn::RNA::UnshareParameters(const bool bKeep)
+{
+	if (m_pParameters.use_count() != 1) {
+		m_pParameters = bKeep ? std::make_shared<Parameters>(*m_pParameters) : std::make_shared<Parameters>();
 	}
+}
 
-	//add connections, this is done on neurons which can be connected to something else. Hence
-	//it should occur on input and hidden neurons, which can possibly connect to hidden neurons
-	//and output neurons
-	for (auto &pInput : m_veInputNeurons) {
-		for (auto &pHidden : m_veHiddenNeurons) {
-			//ensure the connection will not create a recursive value loop
-			NeuronAllele::SET_CONNECTED_NEURONS::const_iterator it = pHidden->setAllConnected.find(pInput);
-
-			if (it != pHidden->setAllConnected.cend() && GetRandomContinuous() < rates.fAddConnection) {
-				MutateNeuronAlleleAddConnection(pInput, pHidden, prevConnection);
-			}
+void fenn::RNA::Resize(const unsigned int nInput, const unsigned int nOutput, const unsigned int nHidden)
+{
+	//the neurons are overwritten by the caller, only the memory is reused
+	UnshareTopology(false);
+	UnshareParameters(false);
+	assert(nInput + nOutput + nHidden <= (unsigned int)((LOCAL_INDEX_TYPE)(~0)) + 1);
+	m_nNumInputNeurons = nInput;
+	m_nNumOutputNeurons = nOutput;
+	m_pTopology->veNeurons.resize(nInput + nOutput + nHidden);
+	m_pParameters->veBiases.resize(m_pTopology->veNeurons.size());
+	m_veVisits.resize(m_pTopology->veNeurons.size());
+}
+
+void fenn::RNA::Clear()
+{
+	UnshareTopology(false);
+	UnshareParameters(false);
+
+	m_nMaxNumHiddenNeurons = 0;
+	m_nNumInputNeurons = 0;
+	m_nNumOutputNeurons = 0;
+	m_pTopology->veNeurons.clear();
+	m_pTopology->veConnections.clear();
+	m_pTopology->nNumConnections = 0;
+	m_pParameters->veBiases.clear();
+	m_pParameters->veWeights.clear();
+	m_pTopology->veNames.clear();
+	m_pTopology->veTopologicalOrder.clear();
+	m_pTopology->edges.Clear();
+	m_nHash = 0;
+	m_veVisits.clear();
+}
+
+void fenn::RNA::WriteStorage(StorageWriter &writer) const
+{
+	//header
+	const unsigned int nNeurons = m_pTopology->veNeurons.size();
+	const unsigned int nSources = nNeurons - m_nNumOutputNeurons;
+
+	writer.WriteBytes(STORAGE_MAGIC, sizeof(STORAGE_MAGIC));
+	writer.WriteByte(STORAGE_VERSION);
+	writer.WriteVarint(m_nNumInputNeurons);
+	writer.WriteVarint(GetNumHiddenNeurons());
+	writer.WriteVarint(m_nNumOutputNeurons);
+	writer.WriteVarint(m_nMaxNumHiddenNeurons);
+
+	//the neurons are written in their storage order (input, hidden and output neurons), the
+	//output neurons have no connections
+	// - the neuron indices, relative to the previous neuron's index
+	GLOBAL_INDEX_TYPE nPrevious = 0;
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		writer.WriteSignedVarint((long long)neuron.nIndex - (long long)nPrevious);
+		nPrevious = neuron.nIndex;
+	}
+
+	// - the neuron names, types and biases
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const std::string &sName = GetNeuronName(m_pTopology->veNeurons[GetStorageNeuron(i)]);
+		writer.WriteVarint(sName.size());
+		writer.WriteBytes(sName.data(), sName.size());
+	}
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		writer.WriteBits((unsigned int)m_pTopology->veNeurons[GetStorageNeuron(i)].eNeuronType, STORAGE_NEURONTYPE_BITS);
+	}
+
+	writer.FlushBits();
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		writer.WriteFloat(m_pParameters->veBiases[GetStorageNeuron(i)]);
+	}
+
+	// - the number of connections of every neuron, followed by the connection indices relative
+	// to the previous connection's index and the storage positions of the connected neurons.
+	// These are always hidden or output neurons, hence the number of input neurons is subtracted
+	for (unsigned int i = 0; i < nSources; i++) {
+		writer.WriteVarint(m_pTopology->veNeurons[GetStorageNeuron(i)].nNumConnections);
+	}
+
+	nPrevious = 0;
+
+	for (unsigned int i = 0; i < nSources; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		const ConnectionAllele* const pConnections = GetConnections(neuron);
+
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			const unsigned int nConnected = GetStoragePosition(pConnections[j].nConnectedNeuron);
+			assert(nConnected >= m_nNumInputNeurons);
+			writer.WriteSignedVarint((long long)pConnections[j].nIndex - (long long)nPrevious);
+			writer.WriteVarint(nConnected - m_nNumInputNeurons);
+			nPrevious = pConnections[j].nIndex;
 		}
+	}
 
-		for (auto &pOutput : m_veOutputNeurons) {
-			//ensure no recursive loop will be created
-			NeuronAllele::SET_CONNECTED_NEURONS::const_iterator it = pOutput->setAllConnected.find(pInput);
+	// - the connection slots and weights
+	for (unsigned int i = 0; i < nSources; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		const ConnectionAllele* const pConnections = GetConnections(neuron);
 
-			if (it != pOutput->setAllConnected.cend() && GetRandomContinuous() < rates.fAddConnection) {
-				MutateNeuronAlleleAddConnection(pInput, pOutput, prevConnection);
-			}
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			writer.WriteBits(pConnections[j].nConnectedSlot, STORAGE_SLOT_BITS);
 		}
 	}
 
-	for (auto &pHiddenOut : m_veHiddenNeurons) {
-		for (auto &pHiddenIn : m_veHiddenNeurons) {
-			if (pHiddenOut != pHiddenIn) {
-				//ensure no value loop will be created
-				NeuronAllele::SET_CONNECTED_NEURONS::const_iterator it = pHiddenIn->setAllConnected.find(pHiddenOut);
+	writer.FlushBits();
 
-				if (it != pHiddenIn->setAllConnected.cend() && GetRandomContinuous() < rates.fAddConnection) {
-					MutateNeuronAlleleAddConnection(pHiddenOut, pHiddenIn, prevConnection);
-				}
-			}
+	for (unsigned int i = 0; i < nSources; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		const WEIGHT_TYPE* const pWeights = GetWeights(neuron);
+
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			writer.WriteFloat(pWeights[j]);
 		}
+	}
 
-		for (auto &pOutput : m_veOutputNeurons) {
-			//ensure the lack of a value loop
-			NeuronAllele::SET_CONNECTED_NEURONS::const_iterator it = pOutput->setAllConnected.find(pHiddenOut);
+	for (unsigned int i = GetFirstOutputNeuron(); i < GetFirstHiddenNeuron(); i++) {
+		assert(m_pTopology->veNeurons[i].nNumConnections == 0);
+	}
+}
 
-			if (it != pOutput->setAllConnected.cend() && GetRandomContinuous() < rates.fAddConnection) {
-				MutateNeuronAlleleAddConnection(pHiddenOut, pOutput, prevConnection);
-			}
+bool fenn::RNA::ReadStorage(StorageReader &reader)
+{
+	//header
+	unsigned char aMagic[sizeof(STORAGE_MAGIC)];
+	reader.ReadBytes(aMagic, sizeof(aMagic));
+
+	if (memcmp(aMagic, STORAGE_MAGIC, sizeof(STORAGE_MAGIC)) != 0 || reader.ReadByte() != STORAGE_VERSION) {
+		return false;
+	}
+
+	const unsigned long long nInputs = reader.ReadVarint();
+	const unsigned long long nHidden = reader.ReadVarint();
+	const unsigned long long nOutputs = reader.ReadVarint();
+	const unsigned long long nMaxHidden = reader.ReadVarint();
+
+	//every neuron takes at least two bytes (its index and the length of its name), which
+	//prevents allocating huge amounts of memory for corrupted data
+	const unsigned long long nRemaining = reader.GetRemaining();
+
+	if (!reader.IsValid() || nInputs > nRemaining || nHidden > nRemaining || nOutputs > nRemaining ||
+		(nInputs + nHidden + nOutputs) * 2 > nRemaining ||
+		nInputs + nHidden + nOutputs > (unsigned long long)((LOCAL_INDEX_TYPE)(~0)) + 1 ||
+		nMaxHidden > (unsigned int)(~0)) {
+		return false;
+	}
+
+	//reuse the memory that is already allocated
+	m_nMaxNumHiddenNeurons = (unsigned int)nMaxHidden;
+	Resize((unsigned int)nInputs, (unsigned int)nOutputs, (unsigned int)nHidden);
+	m_pTopology->veConnections.clear();
+	m_pTopology->nNumConnections = 0;
+	m_pTopology->veNames.clear();
+	m_pTopology->veTopologicalOrder.clear();
+
+	const unsigned int nNeurons = (unsigned int)(nInputs + nHidden + nOutputs);
+	const unsigned int nSources = (unsigned int)(nInputs + nHidden);
+
+	// - the neuron indices, the hidden neurons have to be sorted by their index
+	unsigned long long nIndex = 0;
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const unsigned long long nPrevious = nIndex;
+		nIndex += (unsigned long long)reader.ReadSignedVarint();
+
+		if (nIndex > (GLOBAL_INDEX_TYPE)(~0) || (i > nInputs && i < nSources && nIndex <= nPrevious)) {
+			return false;
 		}
+
+		NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		neuron = NeuronAllele();
+		neuron.nIndex = (GLOBAL_INDEX_TYPE)nIndex;
 	}
 
-	//add neurons, this is done on a connection. Hence the type of mutation should
-	//be applied both to the input neurons as the hidden neurons
-	for (auto &pInput : m_veInputNeurons) {
-		for (auto &connection : pInput->veConnections) {
-			//check if this connection should be mutated
-			if (GetRandomContinuous() < rates.fAddNeuron) {
-				//a neuron should be added
-				MutateConnectionAlleleAddNeuron(&connection, prevNeuron);
-			}
+	// - the neuron names, types and biases
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const unsigned long long nLength = reader.ReadVarint();
+
+		if (nLength > reader.GetRemaining()) {
+			return false;
+		}
+
+		if (nLength > 0) {
+			m_pTopology->veNames.push_back(PAIR_INDEX_NAME(m_pTopology->veNeurons[GetStorageNeuron(i)].nIndex, std::string((size_t)nLength, '\0')));
+			reader.ReadBytes(&m_pTopology->veNames.back().second[0], (unsigned int)nLength);
 		}
 	}
 
-	for (auto &pHidden : m_veHiddenNeurons) {
-		for (auto &connection : pHidden->veConnections) {
-			//check if this connection should be mutated
-			if (GetRandomContinuous() < rates.fAddNeuron) {
-				//a neuron should be added
-				MutateConnectionAlleleAddNeuron(&connection, prevNeuron);
-			}
+	std::sort(m_pTopology->veNames.begin(), m_pTopology->veNames.end(), CompareNameIndex);
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const unsigned int nType = reader.ReadBits(STORAGE_NEURONTYPE_BITS);
+
+		if (nType >= NEURONTYPE_TOTAL && nType != NEURONTYPE_UNKNOWN) {
+			return false;
 		}
+
+		m_pTopology->veNeurons[GetStorageNeuron(i)].eNeuronType = (NeuronType)nType;
+	}
+
+	reader.AlignBits();
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		m_pParameters->veBiases[GetStorageNeuron(i)] = (BIAS_TYPE)reader.ReadFloat();
 	}
 
-	//now start removing neurons. As this type of mutation should only occur on neurons which
-	//have both neurons connected to them as neurons to which they connect, this type of
-	//mutation should only occur on hidden neurons
-	for (auto pHidden : m_veHiddenNeurons) {
-		if (GetRandomContinuous() < rates.fRemoveNeuron) {
-			//a neuron should be removed
-			MutateNeuronAlleleRemoveNeuron(pHidden, prevConnection);
+	// - the number of connections of every neuron, which determines the range of connections
+	// every neuron owns. Every connection takes at least two bytes
+	unsigned int nConnections = 0;
+
+	for (unsigned int i = 0; i < nSources; i++) {
+		const unsigned long long nNeuronConnections = reader.ReadVarint();
+
+		if ((nConnections + nNeuronConnections) * 2 > reader.GetRemaining()) {
+			return false;
 		}
+
+		NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+		neuron.nFirstConnection	= nConnections;
+		neuron.nNumConnections	= (unsigned int)nNeuronConnections;
+		neuron.nMaxConnections	= (unsigned int)nNeuronConnections;
+		nConnections += (unsigned int)nNeuronConnections;
 	}
-}
 
-bool fenn::RNA::ResizeNeuronVector(VECTOR_NEURON_ALLELE &vector, const unsigned int nNewSize) const
-{
-	//most often the neuron vectors will be of the same size, check this first
-	if (vector.size() != nNewSize) {
-		if (vector.size() < nNewSize) { 
-			//current size is smaller than new size, make array larger
-			vector.reserve(nNewSize);
-			const unsigned int nNew = nNewSize - vector.size();
+	for (unsigned int i = nSources; i < nNeurons; i++) {
+		m_pTopology->veNeurons[GetStorageNeuron(i)].nFirstConnection = nConnections;
+	}
+
+	m_pTopology->veConnections.resize(nConnections);
+	m_pParameters->veWeights.resize(nConnections);
+	m_pTopology->nNumConnections = nConnections;
+
+	// - the connections, which are sorted by their index and connect to every neuron at most
+	// once. The connected neurons are marked to detect duplicate connections
+	nIndex = 0;
+
+	for (unsigned int i = 0; i < nSources; i++) {
+		const unsigned int nNeuron = GetStorageNeuron(i);
+		const NeuronAllele &neuron = m_pTopology->veNeurons[nNeuron];
+		const unsigned int nVisit = GetNewVisit();
 
-			for (unsigned int i = 0; i < nNew; i++) {
-				vector.push_back(CreateNeuronAllele());
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			const unsigned long long nPrevious = nIndex;
+			nIndex += (unsigned long long)reader.ReadSignedVarint();
+			const unsigned long long nConnected = reader.ReadVarint();
+
+			if (nIndex > (GLOBAL_INDEX_TYPE)(~0) || (j > 0 && nIndex <= nPrevious) || nConnected >= nHidden + nOutputs) {
+				return false;
 			}
-		} else if (vector.size() > nNewSize) {
-			//current size is larger than new size, make array smaller
-			for (auto it = vector.begin() + nNewSize; it != vector.end(); ++it) {
-				ReleaseNeuronAllele(*it);
+
+			const unsigned int nConnectedNeuron = GetStorageNeuron((unsigned int)(nInputs + nConnected));
+
+			if (m_veVisits[nConnectedNeuron] == nVisit) {
+				return false;
 			}
 
-			vector.resize(nNewSize);
+			m_veVisits[nConnectedNeuron] = nVisit;
+
+			ConnectionAllele &newConnection = m_pTopology->veConnections[neuron.nFirstConnection + j];
+			newConnection = ConnectionAllele();
+			newConnection.nIndex			= (GLOBAL_INDEX_TYPE)nIndex;
+			newConnection.nConnectedNeuron	= (LOCAL_INDEX_TYPE)nConnectedNeuron;
 		}
+	}
 
-		return true;
+	// - the connection slots and weights, the connections are stored in the same order as the
+	// sources
+	for (unsigned int i = 0; i < nSources; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			const unsigned int nSlot = reader.ReadBits(STORAGE_SLOT_BITS);
+
+			if (nSlot > SLOT_MAX) {
+				return false;
+			}
+
+			m_pTopology->veConnections[neuron.nFirstConnection + j].nConnectedSlot = (SLOT_INDEX_TYPE)nSlot;
+		}
 	}
 
-	return false;
+	reader.AlignBits();
+
+	for (unsigned int i = 0; i < nSources; i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[GetStorageNeuron(i)];
+
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			m_pParameters->veWeights[neuron.nFirstConnection + j] = (WEIGHT_TYPE)reader.ReadFloat();
+		}
+	}
+
+	//the data may still describe a value loop, which is detected while ordering the neurons
+	return reader.IsValid() && RebuildTopologicalOrder();
 }
 
-fenn::NeuronAllele* fenn::RNA::CreateNeuronAllele()
+unsigned int fenn::RNA::GetStorageNeuron(const unsigned int nPosition) const
 {
-	return new NeuronAllele;
+	//the binary format stores the hidden neurons before the output neurons
+	const unsigned int nHidden = GetNumHiddenNeurons();
+
+	if (nPosition < m_nNumInputNeurons) {
+		return nPosition;
+	} else if (nPosition < m_nNumInputNeurons + nHidden) {
+		return GetFirstHiddenNeuron() + (nPosition - m_nNumInputNeurons);
+	}
+
+	assert(nPosition < m_pTopology->veNeurons.size());
+	return m_nNumInputNeurons + (nPosition - m_nNumInputNeurons - nHidden);
 }
 
-fenn::NeuronAllele* fenn::RNA::CreateNeuronAllele(const NeuronAllele &allele)
+unsigned int fenn::RNA::GetStoragePosition(const unsigned int nNeuron) const
 {
-	return new NeuronAllele(allele);
+	if (nNeuron < m_nNumInputNeurons) {
+		return nNeuron;
+	} else if (nNeuron < GetFirstHiddenNeuron()) {
+		return nNeuron + GetNumHiddenNeurons();
+	}
+
+	assert(nNeuron < m_pTopology->veNeurons.size());
+	return nNeuron - m_nNumOutputNeurons;
 }
 
-void fenn::RNA::ReleaseNeuronAllele(NeuronAllele *pAllele)
+void fenn::RNA::RecombineNeuronAllele(const unsigned int nTarget, const RNA &parentChampion, const RNA &parent, const unsigned int nParent)
 {
-	delete pAllele;
+	//this function will recombine the neurons based on randomly generated numbers, the target
+	//neuron has the same local index as the champion's neuron
+	const bool bChampion = GetRandomBinary();
+	const RNA &toUse = bChampion ? parentChampion : parent;
+	const unsigned int nToUse = bChampion ? nTarget : nParent;
+
+	m_pTopology->veNeurons[nTarget].nIndex			= toUse.m_pTopology->veNeurons[nToUse].nIndex;
+	m_pTopology->veNeurons[nTarget].eNeuronType	= toUse.m_pTopology->veNeurons[nToUse].eNeuronType;
+	m_pParameters->veBiases[nTarget]					= toUse.m_pParameters->veBiases[nToUse];
 }
 
-void fenn::RNA::ReleaseAll()
+void fenn::RNA::RecombineNeuronAlleleConnections(const unsigned int nTarget, const RNA &parentChampion, const NeuronAllele &champion, const RNA &parent, const NeuronAllele *pParent)
 {
-	//delete all dynamically allocated neurons
-	for (auto pNeuron : m_veInputNeurons) {
-		ReleaseNeuronAllele(pNeuron);
-	}
+	//This function will reconstruct the connections for the provided neuron from the parent
+	//neurons, the other parent may be NULL if it doesn't contain the neuron. The connections
+	//of both parents are sorted by their index, such that matching connections are found by
+	//advancing through the connections of the other parent only once.
+	NeuronAllele &target = m_pTopology->veNeurons[nTarget];
+	target.nFirstConnection	= m_pTopology->veConnections.size();
+	target.nNumConnections	= champion.nNumConnections;
+	target.nMaxConnections	= champion.nNumConnections;
+
+	const ConnectionAllele* const pChampion = parentChampion.GetConnections(champion);
+	const WEIGHT_TYPE* const pChampionWeights = parentChampion.GetWeights(champion);
+	const ConnectionAllele *pOther = pParent ? parent.GetConnections(*pParent) : NULL;
+	const ConnectionAllele* const pOtherEnd = pParent ? pOther + pParent->nNumConnections : NULL;
+
+	for (unsigned int i = 0; i < champion.nNumConnections; i++) {
+		while (pOther != pOtherEnd && pOther->nIndex < pChampion[i].nIndex) {
+			++pOther;
+		}
 
-	m_veInputNeurons.clear();
+		//when a matching connection was found choose slot and weight on the basis of random
+		//numbers, otherwise only use the data coming from the champion
+		const ConnectionAllele *pToUse = &pChampion[i];
+		WEIGHT_TYPE fWeight = pChampionWeights[i];
 
-	for (auto pNeuron : m_veHiddenNeurons) {
-		ReleaseNeuronAllele(pNeuron);
-	}
+		if (pOther != pOtherEnd && pOther->nIndex == pChampion[i].nIndex && !GetRandomBinary()) {
+			pToUse = pOther;
+			fWeight = parent.m_pParameters->veWeights[pOther - parent.m_pTopology->veConnections.data()];
+		}
 
-	m_veHiddenNeurons.clear();
+		ConnectionAllele newConnection;
+		newConnection.nIndex			= pChampion[i].nIndex;
+		newConnection.nConnectedNeuron	= pChampion[i].nConnectedNeuron;
+		newConnection.nConnectedSlot	= pToUse->nConnectedSlot;
 
-	for (auto pNeuron : m_veOutputNeurons) {
-		ReleaseNeuronAllele(pNeuron);
+		m_pTopology->veConnections.push_back(newConnection);
+		m_pParameters->veWeights.push_back(fWeight);
 	}
+}
 
-	m_veOutputNeurons.clear();
+unsigned int fenn::RNA::FindConnectionAllele(const unsigned int nNeuron, const GLOBAL_INDEX_TYPE nIndex) const
+{
+	//returns the position of the connection within the connection array
+	const NeuronAllele &neuron = m_pTopology->veNeurons[nNeuron];
+	const ConnectionAllele* const pFirst = GetConnections(neuron);
+	const ConnectionAllele* const pFound = std::lower_bound(pFirst, pFirst + neuron.nNumConnections, nIndex, CompareConnectionToIndex);
+	assert(pFound != pFirst + neuron.nNumConnections && pFound->nIndex == nIndex);
+	return neuron.nFirstConnection + (pFound - pFirst);
 }
 
-void fenn::RNA::RecombineNeuronAllele(NeuronAllele *pTarget, NeuronAllele *pParentChampion, NeuronAllele *pParent)
+void fenn::RNA::InsertConnectionAllele(const unsigned int nNeuron, const ConnectionAllele &connection, const WEIGHT_TYPE fWeight)
 {
-	//this function will recombine the neurons based on randomly generated numbers
-	const NeuronAllele* const pToUse = GetRandomBinary() ? pParentChampion : pParent;
-	pTarget->sName		= pToUse->sName;
-	pTarget->nIndex		= pToUse->nIndex;
-	pTarget->eNeuronType = pToUse->eNeuronType;
-	pTarget->fBias		= pToUse->fBias;
+	NeuronAllele &neuron = m_pTopology->veNeurons[nNeuron];
+
+	if (neuron.nNumConnections == neuron.nMaxConnections) {
+		//there is no room left, move the connections to the end of the array while reserving
+		//room for more connections. The previous range is unused until the arrays are compacted
+		const unsigned int nFirst = m_pTopology->veConnections.size();
+		const unsigned int nMax = std::max(RNA_CONNECTION_RESERVE, neuron.nNumConnections * 2);
+		m_pTopology->veConnections.resize(nFirst + nMax);
+		m_pParameters->veWeights.resize(nFirst + nMax);
+
+		if (neuron.nNumConnections > 0) {
+			memcpy(&m_pTopology->veConnections[nFirst], &m_pTopology->veConnections[neuron.nFirstConnection], neuron.nNumConnections * sizeof(ConnectionAllele));
+			memcpy(&m_pParameters->veWeights[nFirst], &m_pParameters->veWeights[neuron.nFirstConnection], neuron.nNumConnections * sizeof(WEIGHT_TYPE));
+		}
+
+		neuron.nFirstConnection = nFirst;
+		neuron.nMaxConnections = nMax;
+	}
+
+	//insert the connection such that the connections remain sorted by their index, no two
+	//connections may connect the same neurons
+	assert(!IsConnected(nNeuron, connection.nConnectedNeuron));
+	ConnectionAllele* const pFirst = &m_pTopology->veConnections[neuron.nFirstConnection];
+	ConnectionAllele* const pLast = pFirst + neuron.nNumConnections;
+	ConnectionAllele* const pInsert = std::upper_bound(pFirst, pLast, connection, CompareConnectionIndex);
+	WEIGHT_TYPE* const pWeight = &m_pParameters->veWeights[neuron.nFirstConnection + (pInsert - pFirst)];
+
+	memmove(pInsert + 1, pInsert, (pLast - pInsert) * sizeof(ConnectionAllele));
+	memmove(pWeight + 1, pWeight, (pLast - pInsert) * sizeof(WEIGHT_TYPE));
+	*pInsert = connection;
+	*pWeight = fWeight;
+	neuron.nNumConnections++;
+	m_nHash += HashConnectionGene(connection, fWeight);
+	m_pTopology->nNumConnections++;
+	m_pTopology->edges.Insert(neuron.nIndex, m_pTopology->veNeurons[connection.nConnectedNeuron].nIndex, connection.nIndex);
 }
 
-void fenn::RNA::CreateNeuronAlleleConnections(NeuronAllele *pTarget, NeuronAllele *pSource, const std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> &map)
+void fenn::RNA::EraseConnectionAllele(const unsigned int nNeuron, const unsigned int nPosition)
 {
-	//reserve size for connections
-	pTarget->veConnections.reserve(pSource->veConnections.size());
+	NeuronAllele &neuron = m_pTopology->veNeurons[nNeuron];
+	assert(nPosition >= neuron.nFirstConnection && nPosition < neuron.nFirstConnection + neuron.nNumConnections);
 
-	for (const auto &source : pSource->veConnections) {
-		//copy all data from the source neuron
-		ConnectionAllele newConnection;
-		assert(map.find(source.pParentNeuron->nIndex)->second == pTarget);
+	m_nHash -= HashConnection(nPosition);
+	m_pTopology->edges.Erase(neuron.nIndex, m_pTopology->veNeurons[m_pTopology->veConnections[nPosition].nConnectedNeuron].nIndex);
 
-		newConnection.nIndex = source.nIndex;
-		newConnection.pParentNeuron = pTarget;
-		newConnection.pConnectedNeuron = map.find(source.pConnectedNeuron->nIndex)->second;
-		newConnection.nConnectedSlot = source.nConnectedSlot;
-		newConnection.fWeight = source.fWeight;
+	//the following connections move down one position, the room at the end stays reserved
+	const unsigned int nFollowing = neuron.nFirstConnection + neuron.nNumConnections - nPosition - 1;
 
-		pTarget->veConnections.push_back(newConnection);
-		newConnection.pConnectedNeuron->veConnected.push_back(pTarget);
+	if (nFollowing > 0) {
+		memmove(&m_pTopology->veConnections[nPosition], &m_pTopology->veConnections[nPosition + 1], nFollowing * sizeof(ConnectionAllele));
+		memmove(&m_pParameters->veWeights[nPosition], &m_pParameters->veWeights[nPosition + 1], nFollowing * sizeof(WEIGHT_TYPE));
 	}
+
+	neuron.nNumConnections--;
+	m_pTopology->nNumConnections--;
 }
 
-void fenn::RNA::RecombineNeuronAlleleConnections(NeuronAllele *pTarget, NeuronAllele *pParentChampion, NeuronAllele *pParent, const std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> &map)
+bool fenn::RNA::IsConnected(const unsigned int nSource, const unsigned int nTarget) const
 {
-	//this function will reconstruct the connections for the provided neuron from the parent
-	//neurons. The map should contain a map of all neurons in the neural network
-	assert(pTarget->veConnections.empty());
-
-	auto pNeuronOld = pParent->veConnections.cbegin();
+	return m_pTopology->edges.Find(m_pTopology->veNeurons[nSource].nIndex, m_pTopology->veNeurons[nTarget].nIndex);
+}
 
-	for (const auto &pChampion : pParentChampion->veConnections) {
-		//look for a connection with an index matching to the champion parent connection's index
-		auto pNeuronNew = pNeuronOld;
+void fenn::RNA::Compact()
+{
+	//This function removes the hidden neurons marked as removed, sorts the hidden neurons by
+	//their index and moves the connections of every neuron back into consecutive ranges in
+	//the order of the neurons. The local indices of the hidden neurons change, hence the
+	//connections and the topological order are updated as well.
+	const unsigned int nFirstHidden = GetFirstHiddenNeuron();
+	bool bSorted = true;
+
+	m_veSearchStack.clear();
+
+	for (unsigned int i = nFirstHidden; i < m_pTopology->veNeurons.size(); i++) {
+		if (m_pTopology->veNeurons[i].nOrder != ORDER_REMOVED) {
+			if (!m_veSearchStack.empty() && m_pTopology->veNeurons[m_veSearchStack.back()].nIndex > m_pTopology->veNeurons[i].nIndex) {
+				bSorted = false;
+			}
 
-		while (pNeuronNew != pParent->veConnections.cend() && pNeuronNew->nIndex != pChampion.nIndex) {
-			pNeuronNew++;
+			m_veSearchStack.push_back((LOCAL_INDEX_TYPE)i);
 		}
+	}
 
-		//check if a matching neuron was found
-		if (pNeuronNew != pParent->veConnections.cend()) {
-			//a matching connection was found, the new connection should be a recombination of
-			//the two parent neuron's connections.
-			ConnectionAllele newConnection;
-			newConnection.nIndex = pChampion.nIndex;
-			
-			//find the parent and connected neuron's new pointer value using the map
-			assert(map.find(pChampion.pParentNeuron->nIndex)->second == pTarget);
-			newConnection.pParentNeuron = pTarget;
-			newConnection.pConnectedNeuron = map.find(pChampion.pConnectedNeuron->nIndex)->second;
+	//every gap in the connections is the result of a mutation, without any the arrays are compact
+	if (bSorted && m_veSearchStack.size() == GetNumHiddenNeurons() && m_pTopology->nNumConnections == m_pTopology->veConnections.size()) {
+		return;
+	}
+
+	if (!bSorted) {
+		std::sort(m_veSearchStack.begin(), m_veSearchStack.end(), CompareNeuronIndex(m_pTopology->veNeurons.data()));
+	}
 
-			//choose slot and weight on the basis of random numbers
-			const ConnectionAllele* const pToUse = GetRandomBinary() ? &pChampion : &(*pNeuronNew);
+	//determine the new local index of every remaining neuron
+	const unsigned int nNeurons = nFirstHidden + m_veSearchStack.size();
+	m_veCompactIndices.resize(m_pTopology->veNeurons.size());
 
-			newConnection.nConnectedSlot = pToUse->nConnectedSlot;
-			newConnection.fWeight = pToUse->fWeight;
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const unsigned int nNeuron = i < nFirstHidden ? i : m_veSearchStack[i - nFirstHidden];
+		m_veCompactIndices[nNeuron] = (LOCAL_INDEX_TYPE)i;
+	}
 
-			pTarget->veConnections.push_back(newConnection);
-			newConnection.pConnectedNeuron->veConnected.push_back(pTarget);
+	//copy the neurons and their connections in their new order, along with their parameters
+	m_veCompactNeurons.resize(nNeurons);
+	m_veCompactBiases.resize(nNeurons);
+	m_veCompactConnections.resize(m_pTopology->nNumConnections);
+	m_veCompactWeights.resize(m_pTopology->nNumConnections);
+	unsigned int nConnections = 0;
+
+	for (unsigned int i = 0; i < nNeurons; i++) {
+		const unsigned int nNeuron = i < nFirstHidden ? i : m_veSearchStack[i - nFirstHidden];
+		const NeuronAllele &neuron = m_pTopology->veNeurons[nNeuron];
+		const ConnectionAllele* const pConnections = GetConnections(neuron);
+
+		NeuronAllele &compact = m_veCompactNeurons[i];
+		compact = neuron;
+		compact.nFirstConnection = nConnections;
+		compact.nMaxConnections = neuron.nNumConnections;
+		m_veCompactBiases[i] = m_pParameters->veBiases[nNeuron];
+
+		if (neuron.nNumConnections > 0) {
+			memcpy(&m_veCompactWeights[nConnections], GetWeights(neuron), neuron.nNumConnections * sizeof(WEIGHT_TYPE));
+		}
 
-			//update the iterator finding the connections in the non-championing parent
-			pNeuronOld = pNeuronNew;
-			++pNeuronOld;
-		} else {
-			//no matching neuron was found, only use the data coming from the neuron
-			ConnectionAllele newConnection;
-			assert(map.find(pChampion.pParentNeuron->nIndex)->second == pTarget);
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			assert(m_pTopology->veNeurons[pConnections[j].nConnectedNeuron].nOrder != ORDER_REMOVED);
+			ConnectionAllele &connection = m_veCompactConnections[nConnections++];
+			connection = pConnections[j];
+			connection.nConnectedNeuron = m_veCompactIndices[connection.nConnectedNeuron];
+		}
+	}
 
-			newConnection.nIndex			= pChampion.nIndex;
-			newConnection.pParentNeuron		= pTarget;
-			newConnection.pConnectedNeuron	= map.find(pChampion.pConnectedNeuron->nIndex)->second;
-			newConnection.nConnectedSlot	= pChampion.nConnectedSlot;
-			newConnection.fWeight			= pChampion.fWeight;
+	assert(nConnections == m_pTopology->nNumConnections);
 
-			pTarget->veConnections.push_back(newConnection);
-			newConnection.pConnectedNeuron->veConnected.push_back(pTarget);
+	//the previous arrays remain as workspace for the next compaction
+	m_pTopology->veNeurons.swap(m_veCompactNeurons);
+	m_pTopology->veConnections.swap(m_veCompactConnections);
+	m_pParameters->veBiases.swap(m_veCompactBiases);
+	m_pParameters->veWeights.swap(m_veCompactWeights);
+	m_veVisits.resize(m_pTopology->veNeurons.size());
 
-			//as we've found no matching neuron, the iterator finding the matching connections
-			//in the non-championing parent should not be changed
+	for (auto &nNeuron : m_pTopology->veTopologicalOrder) {
+		nNeuron = m_veCompactIndices[nNeuron];
+	}
+}
+
+bool fenn::RNA::RebuildEdgeIndex()
+{
+	//index the connections of every neuron, the index is kept up to date by every mutation
+	//afterwards. The table is reused, unless the topology was replaced by a new block. Fails
+	//when two connections connect the same neurons, which only happens for invalid data
+	m_pTopology->edges.Clear();
+	m_pTopology->edges.Reserve(m_pTopology->nNumConnections);
+
+	for (const auto &neuron : m_pTopology->veNeurons) {
+		const ConnectionAllele* const pConnections = GetConnections(neuron);
+
+		for (unsigned int i = 0; i < neuron.nNumConnections; i++) {
+			if (!m_pTopology->edges.Insert(neuron.nIndex, m_pTopology->veNeurons[pConnections[i].nConnectedNeuron].nIndex, pConnections[i].nIndex)) {
+				return false;
+			}
 		}
 	}
+
+	return true;
 }
 
-void fenn::RNA::CreateNeuronConnectionSets(NeuronAllele *pNew, const NeuronAllele * const pPrev)
+bool fenn::RNA::RebuildTopologicalOrder()
 {
-	//This function is used to construct the neuron connection sets from scratch. As such, this
-	//function should only be called explicitly on the output neurons with pPrev set to NULL.
-	//The other neurons will have their connection sets created by the recursive nature of this
-	//function. This function will clear any previously existing elements of the connection set.
-	pNew->setAllConnected.clear();
+	//This function constructs the topological order from scratch using Kahn's algorithm. It
+	//should be called whenever the neurons are created without a valid order.
+	const unsigned int nFirstHidden = GetFirstHiddenNeuron();
+	const unsigned int nHidden = GetNumHiddenNeurons();
 
-	//copy the previous neuron's connection set to the current one and add the previous neuron's
-	//as well
-	if (pPrev) {
-		pNew->setAllConnected = pPrev->setAllConnected;
-		pNew->setAllConnected.insert((NeuronAllele*)pPrev);
+	for (unsigned int i = 0; i < nFirstHidden; i++) {
+		m_pTopology->veNeurons[i].nOrder = i < m_nNumInputNeurons ? ORDER_INPUT : ORDER_OUTPUT;
 	}
 
-	//call the same function recursively on all neurons connected to this one
-	for (auto pConnected : pNew->veConnected) {
-		CreateNeuronConnectionSets(pConnected, pNew);
+	//count the number of hidden neurons connected to every hidden neuron
+	m_veSearchOrders.assign(nHidden, 0);
+	m_pTopology->veTopologicalOrder.clear();
+
+	for (unsigned int i = nFirstHidden; i < m_pTopology->veNeurons.size(); i++) {
+		const ConnectionAllele* const pConnections = GetConnections(m_pTopology->veNeurons[i]);
+
+		for (unsigned int j = 0; j < m_pTopology->veNeurons[i].nNumConnections; j++) {
+			if (pConnections[j].nConnectedNeuron >= nFirstHidden) {
+				m_veSearchOrders[pConnections[j].nConnectedNeuron - nFirstHidden]++;
+			}
+		}
 	}
-}
 
-void fenn::RNA::AddToNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele* const pNew)
-{
-	//add the new neuron allele's pointer to the connection set of the neuron allele being
-	//processed
-	pToProcess->setAllConnected.insert((NeuronAllele*)pNew);
+	for (unsigned int i = 0; i < nHidden; i++) {
+		if (m_veSearchOrders[i] == 0) {
+			m_pTopology->veTopologicalOrder.push_back((LOCAL_INDEX_TYPE)(nFirstHidden + i));
+		}
+	}
+
+	//the topological order itself is used as the queue of neurons to process. A neuron is
+	//added once all hidden neurons connected to it have been added
+	for (unsigned int i = 0; i < m_pTopology->veTopologicalOrder.size(); i++) {
+		NeuronAllele &neuron = m_pTopology->veNeurons[m_pTopology->veTopologicalOrder[i]];
+		const ConnectionAllele* const pConnections = GetConnections(neuron);
 
-	//call the function recursively on all neuron allele's feeding into the currently processed
-	//one
-	for (auto &pConnected : pToProcess->veConnected) {
-		AddToNeuronConnectionSets(pConnected, pNew);
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			const unsigned int nNext = pConnections[j].nConnectedNeuron;
+
+			if (nNext >= nFirstHidden && --m_veSearchOrders[nNext - nFirstHidden] == 0) {
+				m_pTopology->veTopologicalOrder.push_back((LOCAL_INDEX_TYPE)nNext);
+			}
+		}
+
+		neuron.nOrder = i + 1;
 	}
+
+	//if not all neurons were added the neurons contain a value loop
+	return m_pTopology->veTopologicalOrder.size() == nHidden;
 }
 
-void fenn::RNA::AddToNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele::SET_CONNECTED_NEURONS &toAdd)
+void fenn::RNA::InsertTopologicalOrder(const unsigned int nFirstNew)
 {
-	//add the entire passed set to the connection set of the neuron allele being processed
-	for (auto &neuron : toAdd) {
-		pToProcess->setAllConnected.insert(neuron);
+	//Every neuron from nFirstNew onwards is new and connects to a single existing neuron. The
+	//new neurons are placed directly before the neuron they connect to, or at the end of the
+	//topological order when connecting to an output neuron. As they follow the neurons
+	//connected to them, the order remains valid. The new neurons are sorted by the order of
+	//the neuron they connect to, after which both lists are merged in a single pass.
+	const unsigned int nNew = m_pTopology->veNeurons.size() - nFirstNew;
+
+	if (nNew == 0) {
+		return;
 	}
 
-	//call the function recursively on all neuron allele's feeding into the neuron allele
-	//currently being processed
-	for (auto &pConnected : pToProcess->veConnected) {
-		AddToNeuronConnectionSets(pConnected, toAdd);
+	m_veSearchStack.resize(nNew);
+
+	for (unsigned int i = 0; i < nNew; i++) {
+		m_veSearchStack[i] = (LOCAL_INDEX_TYPE)(nFirstNew + i);
+	}
+
+	std::sort(m_veSearchStack.begin(), m_veSearchStack.end(), CompareTargetOrder(m_pTopology->veNeurons.data(), m_pTopology->veConnections.data()));
+
+	const std::vector<LOCAL_INDEX_TYPE> &veOrder = m_pTopology->veTopologicalOrder;
+	m_veCompactIndices.clear();
+	m_veCompactIndices.reserve(veOrder.size() + nNew);
+	unsigned int iNew = 0;
+
+	for (unsigned int i = 0; i < veOrder.size(); i++) {
+		while (iNew < nNew && GetTargetOrder(m_pTopology->veNeurons.data(), m_pTopology->veConnections.data(), m_veSearchStack[iNew]) <= i + 1) {
+			m_veCompactIndices.push_back(m_veSearchStack[iNew++]);
+		}
+
+		m_veCompactIndices.push_back(veOrder[i]);
+	}
+
+	while (iNew < nNew) {
+		m_veCompactIndices.push_back(m_veSearchStack[iNew++]);
+	}
+
+	//the previous order remains as workspace, all neurons following the first new neuron move
+	m_pTopology->veTopologicalOrder.swap(m_veCompactIndices);
+
+	for (unsigned int i = 0; i < m_pTopology->veTopologicalOrder.size(); i++) {
+		m_pTopology->veNeurons[m_pTopology->veTopologicalOrder[i]].nOrder = i + 1;
 	}
 }
 
-void fenn::RNA::RemoveFromNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele* const pToRemove)
+void fenn::RNA::RemoveTopologicalOrder(const std::vector<LOCAL_INDEX_TYPE> &veRemoved)
 {
-	//remove the old neuron allele's point from the currently processed neuron allele connection set
-	pToProcess->setAllConnected.erase((NeuronAllele*)pToRemove);
+	//remove the neurons from the order in a single pass, the remaining neurons move down and
+	//the removed neurons are marked until the arrays are compacted
+	if (veRemoved.empty()) {
+		return;
+	}
+
+	const unsigned int nRemoved = GetNewVisit();
+
+	for (const auto nNeuron : veRemoved) {
+		m_veVisits[nNeuron] = nRemoved;
+		m_pTopology->veNeurons[nNeuron].nOrder = ORDER_REMOVED;
+	}
 
-	//do the same recursively for all neuron alleles connected to the currently processed one
-	for (auto pConnected : pToProcess->veConnected) {
-		RemoveFromNeuronConnectionSets(pConnected, pToRemove);
+	std::vector<LOCAL_INDEX_TYPE> &veOrder = m_pTopology->veTopologicalOrder;
+	unsigned int nOrder = 0;
+
+	for (unsigned int i = 0; i < veOrder.size(); i++) {
+		if (m_veVisits[veOrder[i]] != nRemoved) {
+			veOrder[nOrder++] = veOrder[i];
+			m_pTopology->veNeurons[veOrder[i]].nOrder = nOrder;
+		}
 	}
+
+	veOrder.resize(nOrder);
 }
 
-void fenn::RNA::MutateNeuronAlleleProperties(NeuronAllele* const pToMutate, const RNAMutationRates &rates)
+bool fenn::RNA::OrderConnection(const unsigned int nSource, const unsigned int nTarget)
 {
-	//mutate all of the neuron allele properties
-	if (GetRandomContinuous() < rates.fMappingFunction) {
-		pToMutate->eNeuronType = world_single::Get().GetRandomNeuronType();
+	//This function checks whether a connection from the source to the target neuron allele can
+	//be added without creating a value loop. If so, the neurons are reordered such that the
+	//source precedes the target. Connections from input neurons, towards output neurons and
+	//between neurons which are already in the correct order never create a value loop.
+	if (m_pTopology->veNeurons[nSource].nOrder < m_pTopology->veNeurons[nTarget].nOrder) {
+		return true;
 	}
 
-	if (GetRandomContinuous() < rates.fBiasRandom) {
-		pToMutate->fBias = world_single::Get().GetRandomBias();
-	}
+	assert(m_pTopology->veNeurons[nSource].nOrder != ORDER_OUTPUT && m_pTopology->veNeurons[nTarget].nOrder != ORDER_INPUT);
 
-	if (GetRandomContinuous() < rates.fBiasAdditive) {
-		pToMutate->fBias += world_single::Get().GetRandomBiasAdditive();
+	if (nSource == nTarget) {
+		return false;
 	}
 
-	//mutate all of the connection allele properties
-	for (auto &connection : pToMutate->veConnections) {
-		if (GetRandomContinuous() < rates.fNeuronSlot) {
-			connection.nConnectedSlot = world_single::Get().GetRandomSlot();
+	//both neurons are hidden neurons in the wrong order. Search all neurons reachable from the
+	//target which precede the source, if the source is reachable the connection would create
+	//a value loop
+	const unsigned int nLower = m_pTopology->veNeurons[nTarget].nOrder;
+	const unsigned int nUpper = m_pTopology->veNeurons[nSource].nOrder;
+	const unsigned int nForward = GetNewVisit();
+
+	m_veSearchForward.clear();
+	m_veSearchStack.clear();
+	m_veSearchStack.push_back((LOCAL_INDEX_TYPE)nTarget);
+	m_veVisits[nTarget] = nForward;
+
+	while (!m_veSearchStack.empty()) {
+		const unsigned int nNeuron = m_veSearchStack.back();
+		m_veSearchStack.pop_back();
+		m_veSearchForward.push_back((LOCAL_INDEX_TYPE)nNeuron);
+
+		const ConnectionAllele* const pConnections = GetConnections(m_pTopology->veNeurons[nNeuron]);
+
+		for (unsigned int i = 0; i < m_pTopology->veNeurons[nNeuron].nNumConnections; i++) {
+			const unsigned int nNext = pConnections[i].nConnectedNeuron;
+
+			if (nNext == nSource) {
+				return false;
+			} else if (m_veVisits[nNext] != nForward && m_pTopology->veNeurons[nNext].nOrder < nUpper) {
+				m_veVisits[nNext] = nForward;
+				m_veSearchStack.push_back((LOCAL_INDEX_TYPE)nNext);
+			}
 		}
+	}
 
-		if (GetRandomContinuous() < rates.fWeightRandom) {
-			connection.fWeight = world_single::Get().GetRandomWeight();
-		} 
+	//search all neurons from which the source is reachable and which follow the target. The
+	//neurons do not store their incoming connections, instead the neurons in between are
+	//visited in reverse topological order: a neuron leads to the source when one of its
+	//connections leads to a neuron already known to lead to the source
+	const unsigned int nBackward = GetNewVisit();
 
-		if (GetRandomContinuous() < rates.fWeightAdditive) {
-			connection.fWeight += world_single::Get().GetRandomWeightAdditive();
+	m_veSearchBackward.clear();
+	m_veSearchBackward.push_back((LOCAL_INDEX_TYPE)nSource);
+	m_veVisits[nSource] = nBackward;
+
+	for (unsigned int nOrder = nUpper - 1; nOrder > nLower; nOrder--) {
+		const unsigned int nNeuron = m_pTopology->veTopologicalOrder[nOrder - 1];
+		const ConnectionAllele* const pConnections = GetConnections(m_pTopology->veNeurons[nNeuron]);
+
+		for (unsigned int i = 0; i < m_pTopology->veNeurons[nNeuron].nNumConnections; i++) {
+			if (m_veVisits[pConnections[i].nConnectedNeuron] == nBackward) {
+				m_veVisits[nNeuron] = nBackward;
+				m_veSearchBackward.push_back((LOCAL_INDEX_TYPE)nNeuron);
+				break;
+			}
 		}
 	}
-}
 
-void fenn::RNA::MutateConnectionAlleleAddNeuron(ConnectionAllele* const pToMutate, std::vector<NeuronMutation> &prevMutations)
-{
-	//This function will mutate a connection allele such that a neuron will be created
-	//between the original source neuron and the original target neuron allele
-	NeuronAllele *pNewNeuron = CreateNeuronAllele();
-	ConnectionAllele newConnectionTowards;
-	ConnectionAllele newConnectionFrom;
+	//reorder only the found neurons using the orders they currently occupy: first the neurons
+	//leading to the source, then the neurons reachable from the target. Both groups keep their
+	//relative order
+	std::reverse(m_veSearchBackward.begin(), m_veSearchBackward.end());
+	std::sort(m_veSearchForward.begin(), m_veSearchForward.end(), CompareNeuronOrder(m_pTopology->veNeurons.data()));
 
-	//check if the mutation already ocurred before
-	bool bMutationOccurred = false;
+	m_veSearchOrders.clear();
 
-	for (const auto &previous : prevMutations) {
-		if (previous.nNeuronOrigin == pToMutate->pParentNeuron->nIndex &&
-			previous.nNeuronTarget == pToMutate->pConnectedNeuron->nIndex) {
-			//mutation already ocurred before
-			pNewNeuron->nIndex			= previous.nNewNeuronIndex;
-			newConnectionTowards.nIndex = previous.nNewConnectionTowards;
-			newConnectionFrom.nIndex	= previous.nNewConnectionFrom;
+	for (const auto nNeuron : m_veSearchBackward) {
+		m_veSearchOrders.push_back(m_pTopology->veNeurons[nNeuron].nOrder);
+	}
 
-			bMutationOccurred = true;
-			break;
-		}
+	for (const auto nNeuron : m_veSearchForward) {
+		m_veSearchOrders.push_back(m_pTopology->veNeurons[nNeuron].nOrder);
 	}
 
-	if (!bMutationOccurred) {
-		//mutation did not occur: get new neuron index
-		pNewNeuron->nIndex = world_single::Get().GetNewNeuronIndex();
-		newConnectionTowards.nIndex = world_single::Get().GetNewConnectionIndex();
-		newConnectionFrom.nIndex = world_single::Get().GetNewConnectionIndex();
+	std::sort(m_veSearchOrders.begin(), m_veSearchOrders.end());
+	unsigned int iOrder = 0;
 
-		//and store the new mutation in the vector for mutations occurring later
-		NeuronMutation &&newMutation{pToMutate->pParentNeuron->nIndex,
-									 pToMutate->pConnectedNeuron->nIndex,
-									 pNewNeuron->nIndex,
-									 newConnectionTowards.nIndex,
-									 newConnectionFrom.nIndex};
-		prevMutations.push_back(newMutation);
+	for (const auto nNeuron : m_veSearchBackward) {
+		m_pTopology->veNeurons[nNeuron].nOrder = m_veSearchOrders[iOrder++];
+		m_pTopology->veTopologicalOrder[m_pTopology->veNeurons[nNeuron].nOrder - 1] = nNeuron;
 	}
 
-	//initialize the new connection going towards the newly created neuron
-	newConnectionTowards.pParentNeuron = pToMutate->pParentNeuron;
-	newConnectionTowards.pConnectedNeuron = pNewNeuron;
-	newConnectionTowards.nConnectedSlot = world_single::Get().GetRandomSlot();
-	newConnectionTowards.fWeight = world_single::Get().GetRandomWeight();
+	for (const auto nNeuron : m_veSearchForward) {
+		m_pTopology->veNeurons[nNeuron].nOrder = m_veSearchOrders[iOrder++];
+		m_pTopology->veTopologicalOrder[m_pTopology->veNeurons[nNeuron].nOrder - 1] = nNeuron;
+	}
 
-	//initialize the new connection coming from the newly created neuron
-	newConnectionFrom.pParentNeuron = pNewNeuron;
-	newConnectionFrom.pConnectedNeuron = pToMutate->pConnectedNeuron;
-	newConnectionFrom.nConnectedSlot = world_single::Get().GetRandomSlot();
-	newConnectionFrom.fWeight = world_single::Get().GetRandomWeight();
+	return true;
+}
 
-	//set remaining variables of the newly created neuron
-	pNewNeuron->eNeuronType = world_single::Get().GetRandomNeuronType();
-	pNewNeuron->fBias = world_single::Get().GetRandomBias();
-	pNewNeuron->veConnections.push_back(newConnectionFrom);
-	pNewNeuron->veConnected.push_back(pToMutate->pParentNeuron);
-	pNewNeuron->setAllConnected = pToMutate->pConnectedNeuron->setAllConnected;
-	pNewNeuron->setAllConnected.insert(pToMutate->pConnectedNeuron);
-
-	//update the neuron to which the new neuron is connected:
-	// - remove original incoming neuron from vector
-	// - add newly created neuron to vector
-	bool bFound = false;
-
-	for (auto& pConnected : pToMutate->pConnectedNeuron->veConnected) {
-		if (pConnected == pToMutate->pParentNeuron) {
-			//found the original connected neuron, set it to the new one
-			pConnected = pNewNeuron;
-			bFound = true;
-			break;
-		}
+unsigned int fenn::RNA::GetNewVisit()
+{
+	//every search uses a new visit value, such that the neurons do not have to be unmarked
+	//after a search. Only when the value wraps around all neurons are reset
+	if (++m_nVisit == 0) {
+		std::fill(m_veVisits.begin(), m_veVisits.end(), 0);
+		m_nVisit = 1;
 	}
 
-	assert(bFound);
+	return m_nVisit;
+}
 
-	//update the neuron which is going to be connected to the new neuron
-	// - removing original connection to next neuron
-	// - add connection to newly created neuron
-	// - update the connection set to add the newly added neuron
-	AddToNeuronConnectionSets(pToMutate->pParentNeuron, pNewNeuron);
+unsigned long long fenn::RNA::HashNeuron(const unsigned int nNeuron) const
+{
+	return HashNeuronGene(m_pTopology->veNeurons[nNeuron], m_pParameters->veBiases[nNeuron]);
+}
 
-	//TODO: Instead of the following, check if *pToMutate = newConnectionTowards works, it should!
-	//for now, work with an assertion
-	bFound = false;
+unsigned long long fenn::RNA::HashConnection(const unsigned int nPosition) const
+{
+	return HashConnectionGene(m_pTopology->veConnections[nPosition], m_pParameters->veWeights[nPosition]);
+}
 
-	for (auto& pConnection : pToMutate->pParentNeuron->veConnections) {
-		if (pConnection.nIndex == pToMutate->nIndex) {
-			//replace the connection with the new connection
-			assert(&pConnection == pToMutate);
-			pConnection = newConnectionTowards;
-			bFound = true;
-			break;
-		}
+unsigned long long fenn::RNA::HashMutatedNeurons(const unsigned int nFirst) const
+{
+	//the combined hash of the neurons selected to mutate, relative to the first neuron
+	unsigned long long nHash = 0;
+
+	for (unsigned int i = 0; i < m_veMutations.size(); i++) {
+		nHash += HashNeuron(nFirst + m_veMutations[i]);
 	}
 
-	assert(bFound);
-	//after the foregoing loop, pToMutate is no long valid (it points to newConnectionTowards)
+	return nHash;
+}
+
+unsigned long long fenn::RNA::HashMutatedConnections() const
+{
+	unsigned long long nHash = 0;
+
+	for (unsigned int i = 0; i < m_veMutations.size(); i++) {
+		nHash += HashConnection(m_veMutations[i]);
+	}
 
-	m_veHiddenNeurons.push_back(pNewNeuron);
+	return nHash;
 }
 
-void fenn::RNA::MutateNeuronAlleleRemoveNeuron(NeuronAllele* const pToMutate, std::vector<ConnectionMutation> &prevMutations) 
+unsigned long long fenn::RNA::ComputeHash() const
 {
-	//start by looping through all neurons which are currently connected to the neuron which is
-	//about to be deleted
-	for (auto& pNeuron : pToMutate->veConnected) {
-		//for the current neuron, connect to all neurons to which the neuron-to-be-deleted is connected
-		for (auto& targetConnection : pToMutate->veConnections) {
-			//but only if it isn't already connected to it
-			bool bAlreadyConnected = false;
+	//the moved connections of a mutating RNA string are not part of any range
+	unsigned long long nHash = 0;
 
-			for (auto& ownConnection : pNeuron->veConnections) {
-				if (targetConnection.pConnectedNeuron == ownConnection.pConnectedNeuron) {
-					//it is already connected
-					bAlreadyConnected = true;
-					break;
-				}
-			}
+	for (unsigned int i = 0; i < m_pTopology->veNeurons.size(); i++) {
+		const NeuronAllele &neuron = m_pTopology->veNeurons[i];
 
-			if (!bAlreadyConnected) {
-				//not already connected, check if the mutation doesn't already exist
-				bool bAlreadyMutated = false;
-				ConnectionAllele newConnection;
-
-				for (auto &mutation : prevMutations) {
-					if (mutation.nNeuronOrigin == pNeuron->nIndex && mutation.nNeuronTarget == targetConnection.pConnectedNeuron->nIndex) {
-						//mutation already exists
-						newConnection.nIndex = mutation.nNewConnectionIndex;
-						bAlreadyMutated = true;
-						break;
-					}
-				}
-
-				if (!bAlreadyMutated) {
-					//mutation doesn't already exist, retrieve new connection index
-					newConnection.nIndex = world_single::Get().GetNewConnectionIndex();
-					
-					//create a new mutation type such that it can be added to the list of mutations
-					ConnectionMutation &&newMutation{pNeuron->nIndex, 
-													 targetConnection.pConnectedNeuron->nIndex,
-													 newConnection.nIndex};
-					prevMutations.push_back(newMutation);
-				}
-
-				//set the remaining connection variables
-				newConnection.pParentNeuron = pNeuron;
-				newConnection.pConnectedNeuron = targetConnection.pConnectedNeuron;
-				newConnection.nConnectedSlot = world_single::Get().GetRandomSlot();
-				newConnection.fWeight = world_single::Get().GetRandomWeight();
-
-				//add the new connection
-				pNeuron->veConnections.push_back(newConnection);
-
-				//assert that the new connection's connected neuron is already in the connection set
-#ifdef _DEBUG
-				bool bFound = false;
-
-				for (auto &pSetElement : pNeuron->setAllConnected) {
-					if (pSetElement == targetConnection.pConnectedNeuron) {
-						bFound = true;
-						break;
-					}
-				}
-
-				assert(bFound);
-#endif
-			}
+		if (neuron.nOrder == ORDER_REMOVED) {
+			continue;
 		}
 
-		//for the current neuron, connected to the to-be-deleted neuron, remove the original
-		//connection to it
-		bool bFound = false;
+		nHash += HashNeuron(i);
 
-		for (NeuronAllele::VECTOR_CONNECTION_ALLELE::const_iterator it = pNeuron->veConnections.cbegin(); it != pNeuron->veConnections.cend(); it++) {
-			if (it->pConnectedNeuron == pToMutate) {
-				//remove the current connection
-				pNeuron->veConnections.erase(it);
-				bFound = true;
-				break;
-			}
+		for (unsigned int j = 0; j < neuron.nNumConnections; j++) {
+			nHash += HashConnection(neuron.nFirstConnection + j);
 		}
+	}
 
-		assert(bFound);
+	return nHash;
+}
 
-		//remove the to-be-deleted neuron from the connection set
-		RemoveFromNeuronConnectionSets(pNeuron, pToMutate);
+void fenn::RNA::MutateProperties(RNAMutationSamplers &samplers)
+{
+	//The properties are mutated per array instead of per neuron. The samplers skip directly to
+	//the next gene to mutate, after which the new parameter values are drawn at once and
+	//applied in a single pass. The arrays are compact, hence every connection is in use. Only
+	//the blocks which actually change are unshared
+	assert(m_pTopology->nNumConnections == m_pTopology->veConnections.size() && m_pParameters->veWeights.size() == m_pTopology->veConnections.size());
+	const unsigned int nFirst = GetFirstOutputNeuron();
+	const unsigned int nNeurons = m_pTopology->veNeurons.size() - nFirst;
+	const unsigned int nConnections = m_pTopology->veConnections.size();
+
+	//the mapping functions of the output and hidden neurons
+	unsigned int nMutations = 0;
+
+	if ((nMutations = SelectMutations(samplers.mappingFunction, nNeurons)) > 0) {
+		UnshareTopology(true);
+
+		for (unsigned int i = 0; i < nMutations; i++) {
+			const unsigned int nNeuron = nFirst + m_veMutations[i];
+			m_nHash -= HashNeuron(nNeuron);
+			m_pTopology->veNeurons[nNeuron].eNeuronType = world_single::Get().GetRandomNeuronType();
+			m_nHash += HashNeuron(nNeuron);
+		}
 	}
 
-	//now loop through all the neurons to which the to-be-removed neuron connects
-	for (auto &connection : pToMutate->veConnections) {
-		//remove the to-be-removed neuron from the connected vector
-		NeuronAllele* const pCurNeuron = connection.pConnectedNeuron;
-		bool bFound = false;
+	//the slots of all connections
+	if ((nMutations = SelectMutations(samplers.neuronSlot, nConnections)) > 0) {
+		UnshareTopology(true);
 
-		for (NeuronAllele::VECTOR_CONNECTED_NEURONS::const_iterator it = pCurNeuron->veConnected.cbegin(); it != pCurNeuron->veConnected.cend(); it++) {
-			if ((*it) == pToMutate) {
-				//found the connected neuron to remove
-				pCurNeuron->veConnected.erase(it);
-				bFound = true;
-				break;
-			}
+		for (unsigned int i = 0; i < nMutations; i++) {
+			m_nHash -= HashConnection(m_veMutations[i]);
+			m_pTopology->veConnections[m_veMutations[i]].nConnectedSlot = world_single::Get().GetRandomSlot();
+			m_nHash += HashConnection(m_veMutations[i]);
 		}
+	}
 
-		assert(bFound);
+	//the biases of the output and hidden neurons
+	if ((nMutations = SelectMutations(samplers.biasRandom, nNeurons)) > 0) {
+		UnshareParameters(true);
+		world_single::Get().FillRandomBiases(m_veMutationValues.data(), nMutations);
+		m_nHash -= HashMutatedNeurons(nFirst);
+		ReplaceParameters(m_pParameters->veBiases.data() + nFirst, nNeurons, m_veMutations.data(), m_veMutationValues.data(), nMutations);
+		m_nHash += HashMutatedNeurons(nFirst);
 	}
-	
-	//finally, remove the to-be-removed neuron from the hidden neuron vector and finally delete the
-	//dynamically allocated neuron
-	for (VECTOR_NEURON_ALLELE::const_iterator it = m_veHiddenNeurons.cbegin(); it != m_veHiddenNeurons.cend(); it++) {
-		if ((*it) == pToMutate) {
-			//found the neuron
-			m_veHiddenNeurons.erase(it);
-			ReleaseNeuronAllele(pToMutate);
-			return;
+
+	if ((nMutations = SelectMutations(samplers.biasAdditive, nNeurons)) > 0) {
+		UnshareParameters(true);
+		world_single::Get().FillRandomBiasesAdditive(m_veMutationValues.data(), nMutations);
+		m_nHash -= HashMutatedNeurons(nFirst);
+		AddParameters(m_pParameters->veBiases.data() + nFirst, nNeurons, m_veMutations.data(), m_veMutationValues.data(), nMutations);
+		m_nHash += HashMutatedNeurons(nFirst);
+	}
+
+	//the weights of all connections
+	if ((nMutations = SelectMutations(samplers.weightRandom, nConnections)) > 0) {
+		UnshareParameters(true);
+		world_single::Get().FillRandomWeights(m_veMutationValues.data(), nMutations);
+		m_nHash -= HashMutatedConnections();
+		ReplaceParameters(m_pParameters->veWeights.data(), nConnections, m_veMutations.data(), m_veMutationValues.data(), nMutations);
+		m_nHash += HashMutatedConnections();
+	}
+
+	if ((nMutations = SelectMutations(samplers.weightAdditive, nConnections)) > 0) {
+		UnshareParameters(true);
+		world_single::Get().FillRandomWeightsAdditive(m_veMutationValues.data(), nMutations);
+		m_nHash -= HashMutatedConnections();
+		AddParameters(m_pParameters->veWeights.data(), nConnections, m_veMutations.data(), m_veMutationValues.data(), nMutations);
+		m_nHash += HashMutatedConnections();
+	}
+}
+
+unsigned int fenn::RNA::SelectMutations(MutationSampler &sampler, const unsigned int nCount)
+{
+	//store the positions in [0, nCount) of the genes to mutate, and reserve a value for each.
+	//The number of mutations varies, room for all genes is reserved such that the workspace
+	//does not have to grow whenever more genes than before mutate
+	m_veMutations.clear();
+	m_veMutations.reserve(nCount);
+	m_veMutationValues.reserve(nCount);
+
+	if (nCount > 0) {
+		unsigned long long iGene = sampler.Skip(nCount);
+
+		while (iGene < nCount) {
+			m_veMutations.push_back((unsigned int)iGene);
+
+			//move to the next gene to mutate, taking care not to overflow
+			const unsigned long long nSkip = sampler.Skip(nCount - iGene - 1);
+
+			if (nSkip >= nCount - iGene - 1) {
+				break;
+			}
+
+			iGene += nSkip + 1;
 		}
 	}
 
-	//if this code is reached, the neuron allele is not found in the hidden neuron vector
-	assert(false);
+	m_veMutationValues.resize(m_veMutations.size());
+	return m_veMutations.size();
 }
 
-void fenn::RNA::MutateNeuronAlleleAddConnection(NeuronAllele* pSource, NeuronAllele* const pTarget, std::vector<ConnectionMutation> &prevMutations)
+void fenn::RNA::MutateConnectionAlleleAddNeuron(const unsigned int nSource, const GLOBAL_INDEX_TYPE nConnection, InnovationRegistry &innovations)
 {
-	//check if the mutation has already occurred before
-	bool bMutationOccurred = false;
-	ConnectionAllele newConnection;
+	//This function will mutate a connection allele such that a neuron will be created
+	//between the original source neuron and the original target neuron allele. The new neuron
+	//is appended to the neurons, it is moved to its sorted position when compacting
+	const unsigned int nTarget = m_pTopology->veConnections[FindConnectionAllele(nSource, nConnection)].nConnectedNeuron;
+	const unsigned int nNew = m_pTopology->veNeurons.size();
+	assert(nNew <= (unsigned int)((LOCAL_INDEX_TYPE)(~0)));
 
-	for (auto &mutation : prevMutations) {
-		if (mutation.nNeuronOrigin == pSource->nIndex && mutation.nNeuronTarget == pTarget->nIndex) {
-			//mutation already occurred before
-			newConnection.nIndex = mutation.nNewConnectionIndex;
-			bMutationOccurred = true;
-			break;
+	NeuronAllele newNeuron;
+	ConnectionAllele newConnectionTowards;
+	ConnectionAllele newConnectionFrom;
+
+	//retrieve the indices from the registry, such that the same mutation in another RNA
+	//string of this generation results in the same indices
+	const NeuronMutation mutation = innovations.GetNeuronMutation(m_pTopology->veNeurons[nSource].nIndex, m_pTopology->veNeurons[nTarget].nIndex);
+	newNeuron.nIndex			= mutation.nNewNeuronIndex;
+	newConnectionTowards.nIndex = mutation.nNewConnectionTowards;
+	newConnectionFrom.nIndex	= mutation.nNewConnectionFrom;
+
+	//initialize the new connection going towards the newly created neuron
+	newConnectionTowards.nConnectedNeuron = (LOCAL_INDEX_TYPE)nNew;
+	newConnectionTowards.nConnectedSlot = world_single::Get().GetRandomSlot();
+	const WEIGHT_TYPE fWeightTowards = world_single::Get().GetRandomWeight();
+
+	//initialize the new connection coming from the newly created neuron
+	newConnectionFrom.nConnectedNeuron = (LOCAL_INDEX_TYPE)nTarget;
+	newConnectionFrom.nConnectedSlot = world_single::Get().GetRandomSlot();
+	const WEIGHT_TYPE fWeightFrom = world_single::Get().GetRandomWeight();
+
+	//set remaining variables of the newly created neuron
+	newNeuron.eNeuronType = world_single::Get().GetRandomNeuronType();
+	newNeuron.nFirstConnection = m_pTopology->veConnections.size();
+
+	m_pTopology->veNeurons.push_back(newNeuron);
+	m_pParameters->veBiases.push_back(world_single::Get().GetRandomBias());
+	m_veVisits.push_back(0);
+	m_nHash += HashNeuron(nNew);
+	InsertConnectionAllele(nNew, newConnectionFrom, fWeightFrom);
+
+	//replace the mutated connection by the connection towards the new neuron, the connections
+	//of the source neuron have to remain sorted by their index
+	EraseConnectionAllele(nSource, FindConnectionAllele(nSource, nConnection));
+	InsertConnectionAllele(nSource, newConnectionTowards, fWeightTowards);
+}
+
+void fenn::RNA::MutateNeuronAlleleRemoveNeuron(const unsigned int nRemoved, InnovationRegistry &innovations)
+{
+	//The neurons connected to the to-be-removed neuron are the input neurons and the hidden
+	//neurons preceding it in the topological order, which are searched for a connection to it
+	const unsigned int nOrder = m_pTopology->veNeurons[nRemoved].nOrder;
+	assert(nOrder != ORDER_INPUT && nOrder != ORDER_OUTPUT && nOrder != ORDER_REMOVED);
+
+	const GLOBAL_INDEX_TYPE nRemovedIndex = m_pTopology->veNeurons[nRemoved].nIndex;
+
+	for (unsigned int i = 0; i < m_nNumInputNeurons + nOrder - 1; i++) {
+		const unsigned int nNeuron = i < m_nNumInputNeurons ? i : m_pTopology->veTopologicalOrder[i - m_nNumInputNeurons];
+		GLOBAL_INDEX_TYPE nConnection;
+
+		if (!m_pTopology->edges.Find(m_pTopology->veNeurons[nNeuron].nIndex, nRemovedIndex, &nConnection)) {
+			continue;
+		}
+
+		//for the current neuron, connected to the to-be-deleted neuron, remove the original
+		//connection to it
+		EraseConnectionAllele(nNeuron, FindConnectionAllele(nNeuron, nConnection));
+
+		//for the current neuron, connect to all neurons to which the neuron-to-be-deleted is
+		//connected, but only if it isn't already connected to it. Adding connections may move
+		//the connection array, hence the connections are accessed by their position
+		for (unsigned int j = 0; j < m_pTopology->veNeurons[nRemoved].nNumConnections; j++) {
+			const unsigned int nTarget = m_pTopology->veConnections[m_pTopology->veNeurons[nRemoved].nFirstConnection + j].nConnectedNeuron;
+
+			if (!IsConnected(nNeuron, nTarget)) {
+				//as the new connection bypasses the to-be-deleted neuron the neurons are already in
+				//the correct order
+				assert(m_pTopology->veNeurons[nNeuron].nOrder < m_pTopology->veNeurons[nTarget].nOrder);
+				MutateNeuronAlleleAddConnection(nNeuron, nTarget, innovations);
+			}
 		}
 	}
 
-	if (!bMutationOccurred) {
-		//mutation did not occur, get new index
-		newConnection.nIndex = world_single::Get().GetNewConnectionIndex();
+	//finally, remove the to-be-removed neuron's connections and its name. The neuron is removed
+	//from the topological order along with the other removed neurons, and from the arrays when
+	//they are compacted
+	NeuronAllele &removed = m_pTopology->veNeurons[nRemoved];
+	m_nHash -= HashNeuron(nRemoved);
 
-		//add mutation to the vector of occurred mutations
-		ConnectionMutation &&newMutation{pSource->nIndex,
-										 pTarget->nIndex,
-										 newConnection.nIndex};
-		prevMutations.push_back(newMutation);
+	for (unsigned int i = 0; i < removed.nNumConnections; i++) {
+		m_nHash -= HashConnection(removed.nFirstConnection + i);
+		m_pTopology->edges.Erase(removed.nIndex, m_pTopology->veNeurons[m_pTopology->veConnections[removed.nFirstConnection + i].nConnectedNeuron].nIndex);
 	}
 
+	m_pTopology->nNumConnections -= removed.nNumConnections;
+	removed.nNumConnections = 0;
+	SetNeuronName(nRemoved, NAME_EMPTY);
+}
+
+void fenn::RNA::MutateNeuronAlleleAddConnection(const unsigned int nSource, const unsigned int nTarget, InnovationRegistry &innovations)
+{
+	//retrieve the index of the connection from the registry
+	ConnectionAllele newConnection;
+	newConnection.nIndex = innovations.GetConnectionMutation(m_pTopology->veNeurons[nSource].nIndex, m_pTopology->veNeurons[nTarget].nIndex).nNewConnectionIndex;
+
 	//set the remaining connection properties
-	newConnection.pParentNeuron = pSource;
-	newConnection.pConnectedNeuron = pTarget;
+	newConnection.nConnectedNeuron = (LOCAL_INDEX_TYPE)nTarget;
 	newConnection.nConnectedSlot = world_single::Get().GetRandomSlot();
-	newConnection.fWeight = world_single::Get().GetRandomWeight();
-
-	//add the source neuron to the target neurons connected vector
-	pTarget->veConnected.push_back(pSource);
 
-	//add the new connection to the source neuron and update the connection set
-	pSource->veConnections.push_back(newConnection);
-	AddToNeuronConnectionSets(pSource, pTarget->setAllConnected);
+	//add the new connection to the source neuron
+	InsertConnectionAllele(nSource, newConnection, world_single::Get().GetRandomWeight());
 }
\ No newline at end of file
@@ -4,87 +4,88 @@
 #include "FENNConfig.h"
 #include "FENNNeuronBase.h"
 #include "FENNWorld.h"
+#include "FENNRandom.h"
+#include "FENNInnovation.h"
+#include "FENNEdgeIndex.h"
+
+#include <COMTSmallVector.h>
 
 #include <string>
 #include <vector>
-#include <list>
-#include <set>
+#include <utility>
+#include <memory>
 
 namespace fenn
 {
 	//forward definitions
-	struct NeuronAllele;
+	class StorageWriter;
+	class StorageReader;
 
 	//----------------------------------------------------------------
 	// Structure - ConnectionAllele
 	//----------------------------------------------------------------
 	// This structure represents a neuron connection and is used for
-	// the creation of a brain. Specified is the connection index, the
-	// indices of the neuron this connection belongs to and the neuron
-	// to which it is connected along with the connection slot, and
-	// the connection's weight. This structure is kept publically
-	// accessible to allow the programmer to inspect the contents of
-	// a RNA class. This structure should not be used directly by the
-	// programmer to create a new brain.
+	// the creation of a brain. Specified is the connection index, and
+	// the local index of the neuron to which it is connected along
+	// with the connection slot. The neuron a connection belongs to is
+	// implied by the range of connections it is stored in, the weight
+	// of the connection is stored separately by the RNA at the same
+	// position. This structure is kept publically accessible to allow
+	// the programmer to inspect the contents of a RNA class. This
+	// structure should not be used directly by the programmer to
+	// create a new brain.
+	// Note: The structure does not refer to any memory outside of
+	// itself and should remain trivially copyable, such that RNA
+	// strings can be copied as plain memory. The members are ordered
+	// such that the slot fits in the padding after the local index.
 	//----------------------------------------------------------------
 	struct ConnectionAllele
 	{
-		//(copy) constructors, assignment and destructor
-		// Note: The assignment operator and copy constructor are not 
-		// strictly necessary, but included such that when the type-
-		// definitions change to classes/structures using dynamic
-		// allocations, the structure definition can easily be changed
-		// accordingly.
 		ConnectionAllele();
-		ConnectionAllele(const ConnectionAllele &allele);
-		void operator = (const ConnectionAllele &allele);
-		~ConnectionAllele();
 
 		//structure members
 		GLOBAL_INDEX_TYPE		nIndex;
-		NeuronAllele*			pParentNeuron;
-		NeuronAllele*			pConnectedNeuron;
+		LOCAL_INDEX_TYPE		nConnectedNeuron;
 		SLOT_INDEX_TYPE			nConnectedSlot;
-		WEIGHT_TYPE				fWeight;
 	};
 
 	//----------------------------------------------------------------
 	// Structure - NeuronAllele
 	//----------------------------------------------------------------
 	// This structure represents a neuron configuration and is used to
-	// create a new brain. It specifies a name (only used for the
-	// retrieval of the final brain's mathematical functions), a 
-	// global index unique identifying the neuron, the mapping 
-	// function to use once the neuron is created, the bias associated
-	// with the neuron and a list of connection alleles.
+	// create a new brain. It specifies a global index uniquely
+	// identifying the neuron, the mapping function to use once the
+	// neuron is created and the range of its connection alleles
+	// within the RNA it belongs to, sorted by their index. The bias
+	// of the neuron is stored separately by the RNA. The local index
+	// of a neuron is its position within the RNA. The order is the
+	// position of the neuron in the topological order of the RNA it
+	// belongs to, every connection goes from a neuron with a lower
+	// order to a neuron with a higher order. All input neurons share
+	// the lowest order and all output neurons the highest. Just like
+	// the connection alleles, this structure should remain trivially
+	// copyable.
 	//----------------------------------------------------------------
 	struct NeuronAllele
 	{
-		//typedefinitions
-		typedef std::vector<ConnectionAllele> VECTOR_CONNECTION_ALLELE;
-		typedef std::vector<NeuronAllele*> VECTOR_CONNECTED_NEURONS;
-		typedef std::set<NeuronAllele*> SET_CONNECTED_NEURONS;
-
-		//(copy) constructors, assigment and destructor
 		NeuronAllele();
-		NeuronAllele(const NeuronAllele &allele);
-		void operator = (const NeuronAllele &allele);
-		~NeuronAllele();
 
 		//structure members
-		std::string				sName;
 		GLOBAL_INDEX_TYPE		nIndex;
 		NeuronType				eNeuronType;
-		BIAS_TYPE				fBias;
-		VECTOR_CONNECTION_ALLELE veConnections; //the connection alleles pointing to other neurons
-		VECTOR_CONNECTED_NEURONS veConnected; //all neurons which are connected to this neuron
-		SET_CONNECTED_NEURONS	setAllConnected; //the indices of neurons that this neuron somehow connects to (indirectly as well)
+		unsigned int			nFirstConnection; //position of the first connection allele in the RNA
+		unsigned int			nNumConnections;
+		unsigned int			nMaxConnections; //room reserved for connections, only larger while mutating
+		unsigned int			nOrder; //the position in the topological order of the RNA
 	};
 
 	//----------------------------------------------------------------
 	// Structure - RNAMutationRates
 	//----------------------------------------------------------------
-	// This structures contains all mutation rates.
+	// This structures contains all mutation rates. The sampling method
+	// determines how the per-gene mutation decisions are made, the
+	// geometric method only draws random numbers for the genes that
+	// actually mutate and is therefore much faster for low rates.
 	//----------------------------------------------------------------
 	struct RNAMutationRates {
 		CHANCE_TYPE	fMappingFunction;
@@ -96,40 +97,52 @@ namespace fenn
 		CHANCE_TYPE fAddConnection;
 		CHANCE_TYPE fWeightRandom;
 		CHANCE_TYPE fWeightAdditive;
+		MutationSampling eSampling;
 	};
 
 	//----------------------------------------------------------------
-	// Structure - NeuronMutation
+	// Structure - RNAMutationSamplers
 	//----------------------------------------------------------------
-	// When mutating multiple RNA strings within the same generation
-	// the possiblity exists that the exact same mutation occurs
-	// twice. In this case the newly created neuron should receive the
-	// same global index as the previously generated neuron. This 
-	// structure helps in tracking those neuron mutations
+	// A mutation sampler for every mutation rate, used while mutating
+	// a single RNA string. Every sampler handles all genes of its
+	// mutation type as one sequence.
 	//----------------------------------------------------------------
-	struct NeuronMutation
-	{
-		GLOBAL_INDEX_TYPE		nNeuronOrigin;		//index of the neuron connected to the new neuron
-		GLOBAL_INDEX_TYPE		nNeuronTarget;		//index of the neuron that this neuron connects to
-		GLOBAL_INDEX_TYPE		nNewNeuronIndex;	//index of the newly created neuron
-		GLOBAL_INDEX_TYPE		nNewConnectionTowards; //index of the new connection toward the newly created neuron
-		GLOBAL_INDEX_TYPE		nNewConnectionFrom;	//index of the new connection from the newly created neuron
+	struct RNAMutationSamplers {
+		explicit RNAMutationSamplers(const RNAMutationRates &rates);
+
+		MutationSampler mappingFunction;
+		MutationSampler addNeuron;
+		MutationSampler removeNeuron;
+		MutationSampler neuronSlot;
+		MutationSampler biasRandom;
+		MutationSampler biasAdditive;
+		MutationSampler addConnection;
+		MutationSampler weightRandom;
+		MutationSampler weightAdditive;
 	};
 
 	//----------------------------------------------------------------
-	// Structure - ConnectionMutation
+	// Structure - RNAMutationPlan
 	//----------------------------------------------------------------
-	// When mutation multiple RNA strings within the same generation
-	// the possiblity exists that the exact same connection mutation
-	// occurs twice. In this case the second occurrence should not 
-	// request a new global connection index but reuse the old one. 
-	// This structure helps keeping track of those mutations.
+	// The mutations selected for a RNA string by RNA::PlanMutations,
+	// which are performed by RNA::ApplyMutations. The structural
+	// mutations are recorded by the local indices of the neurons
+	// involved, the mapping functions, slots, biases and weights are
+	// mutated with the stored rates while applying. A plan can be
+	// applied to the RNA string it was planned for or to any copy of
+	// it with the same genes, applying it to other genes fails. The
+	// lists keep their capacity, such that a plan can be reused
+	// without allocating memory.
 	//----------------------------------------------------------------
-	struct ConnectionMutation
-	{
-		GLOBAL_INDEX_TYPE		nNeuronOrigin;
-		GLOBAL_INDEX_TYPE		nNeuronTarget;
-		GLOBAL_INDEX_TYPE		nNewConnectionIndex;
+	struct RNAMutationPlan {
+		RNAMutationPlan();
+
+		RNAMutationRates rates;
+		unsigned int nNumNeurons; //the number of neurons and hash of the planned RNA string, used to
+		unsigned long long nHash; //verify the plan is applied to the same genes
+		std::vector<std::pair<LOCAL_INDEX_TYPE, LOCAL_INDEX_TYPE> > veAddConnections; //source and target neuron
+		std::vector<std::pair<LOCAL_INDEX_TYPE, GLOBAL_INDEX_TYPE> > veAddNeurons; //source neuron and connection index
+		std::vector<LOCAL_INDEX_TYPE> veRemoveNeurons;
 	};
 
 	//----------------------------------------------------------------
@@ -153,66 +166,181 @@ namespace fenn
 	class RNA
 	{
 	public:
-		//(copy) constructors, assignment and destructor
+		//(copy) constructors, assignment and destructor. Copies share the genes until either of
+		//them changes (copy-on-write). Moving swaps the contents, a moved-from RNA string either
+		//holds the previous contents of the target or, when move constructed, nothing at all. In
+		//the latter case it may only be assigned, created, loaded or destroyed
 		RNA();
 		RNA(const RNA &rna);
+		RNA(RNA &&rna) FENN_NOEXCEPT;
 		void operator = (const RNA &rna);
+		void operator = (RNA &&rna) FENN_NOEXCEPT;
 		~RNA();
 
 		//saving and loading to/from a bitstring
 		unsigned int GetStorageSize() const;
-		bool Save(unsigned char *pData, unsigned int nMax) const;
-		bool Load(unsigned char *pData, const unsigned int nSize);
+		bool Save(unsigned char *pData, unsigned int nMax, unsigned int *pSize = NULL) const;
+		bool Load(const unsigned char *pData, const unsigned int nSize);
 
 		//creation of RNA
 		void Create(const unsigned int nInput, const unsigned int nMaxHidden, const unsigned int nOutput);
 		void Create(RNA* const pParentChampion, RNA* const pParent);
+		void Create(const RNA &rna); //copies the genes into the memory of this RNA instead of sharing them
+
+		//creating, loading and mutating reuse the memory of this RNA string when it is not shared,
+		//hence recycling the RNA strings of a previous generation does not allocate any memory once
+		//the capacities have settled
 
 		//mutation of RNA
 		// - mutating neurons
-		void Mutate(const RNAMutationRates &rates, std::vector<NeuronMutation> &prevNeuron, std::vector<ConnectionMutation> &prevConnection);
+		void Mutate(const RNAMutationRates &rates, InnovationRegistry &innovations);
+		// - mutating only the mapping functions, slots, biases and weights, which leaves the
+		// structure and the innovation indices untouched
+		void MutateParameters(const RNAMutationRates &rates);
+		// - selecting the mutations without changing the RNA string, and performing them. This is
+		// what Mutate(...) does. Planning only reads the RNA string, hence the mutations of many
+		// RNA strings can be planned simultaneously. A plan only refers to genes that existed
+		// when planning, hence a new neuron is never removed by the same plan. Applying fails,
+		// leaving the RNA string unchanged, when the plan was made for other genes
+		void PlanMutations(const RNAMutationRates &rates, RNAMutationPlan &plan) const;
+		bool ApplyMutations(const RNAMutationPlan &plan, InnovationRegistry &innovations);
+
+		//inspecting the neuron alleles, these are identified by their local index
+		unsigned int GetNumNeurons() const;
+		unsigned int GetNumInputNeurons() const;
+		unsigned int GetNumOutputNeurons() const;
+		unsigned int GetNumHiddenNeurons() const;
+		unsigned int GetFirstOutputNeuron() const;
+		unsigned int GetFirstHiddenNeuron() const;
+		const NeuronAllele& GetNeuron(const unsigned int nNeuron) const;
+		const ConnectionAllele* GetConnections(const NeuronAllele &neuron) const;
+		const WEIGHT_TYPE* GetWeights(const NeuronAllele &neuron) const;
+		const BIAS_TYPE* GetBiases() const; //the bias of every neuron, by local index
+
+		//identifying the genes, RNA strings with the same genes have the same hash. The names of
+		//the neurons are not part of the hash
+		unsigned long long GetHash() const;
+
+		//naming neurons, the name is only used to inspect the brain
+		const std::string& GetNeuronName(const NeuronAllele &neuron) const;
+		void SetNeuronName(const unsigned int nNeuron, const std::string &sName);
 
 	protected:
+		//typedefinitions
+		typedef std::pair<GLOBAL_INDEX_TYPE, std::string> PAIR_INDEX_NAME;
+
 		//keeping track of the maximum number of neurons
 		unsigned int				m_nMaxNumHiddenNeurons;
 
-		//the neuron alleles
-		typedef std::vector<NeuronAllele*> VECTOR_NEURON_ALLELE;
-		VECTOR_NEURON_ALLELE		m_veInputNeurons;
-		VECTOR_NEURON_ALLELE		m_veHiddenNeurons;
-		VECTOR_NEURON_ALLELE		m_veOutputNeurons;
+		//the structure of the RNA: the neuron and connection alleles, the names of the neurons
+		//that have one (sorted by the global index of the neuron), the hidden neurons in
+		//topological order and the connections by the pair of neurons they connect. The order
+		//of a hidden neuron is its position in the topological order plus one. The neurons are
+		//stored as input, output and hidden neurons, the latter sorted by their global index.
+		//Every neuron owns a consecutive range of connections, which refer to neurons by their
+		//local index. While mutating, a range may be moved to the end of the array to make room
+		//and new hidden neurons are appended, until the arrays are compacted again
+		struct Topology {
+			Topology();
+
+			std::vector<NeuronAllele>		veNeurons;
+			std::vector<ConnectionAllele>	veConnections;
+			unsigned int					nNumConnections; //number of connections in use, excluding moved ones
+			std::vector<PAIR_INDEX_NAME>	veNames;
+			std::vector<LOCAL_INDEX_TYPE>	veTopologicalOrder;
+			EdgeIndex						edges;
+		};
+
+		//the parameters, stored at the same positions as the neurons and connections they belong to
+		struct Parameters {
+			std::vector<BIAS_TYPE>			veBiases;
+			std::vector<WEIGHT_TYPE>		veWeights;
+		};
+
+		//the neuron and connection alleles, both blocks are shared with copies of this RNA
+		unsigned int				m_nNumInputNeurons;
+		unsigned int				m_nNumOutputNeurons;
+		std::shared_ptr<Topology>	m_pTopology;
+		std::shared_ptr<Parameters>	m_pParameters;
+
+		//the sum of the hashes of all genes, updated along with every gene that changes. Hence it
+		//does not depend on the layout of the arrays
+		unsigned long long			m_nHash;
+
+		//workspace used while searching and mutating the neuron graph, the visits store the last
+		//search that visited each neuron
+		std::vector<unsigned int>	m_veVisits;
+		unsigned int				m_nVisit;
+		std::vector<LOCAL_INDEX_TYPE> m_veSearchStack;
+		comt::SmallVector<LOCAL_INDEX_TYPE, RNA_SEARCH_INLINE> m_veSearchForward; //usually only a few neurons have to be reordered
+		comt::SmallVector<LOCAL_INDEX_TYPE, RNA_SEARCH_INLINE> m_veSearchBackward;
+		std::vector<unsigned int>	m_veSearchOrders;
+		RNAMutationPlan				m_plan; //used by Mutate(...)
+		std::vector<NeuronAllele>	m_veCompactNeurons;
+		std::vector<ConnectionAllele> m_veCompactConnections;
+		std::vector<LOCAL_INDEX_TYPE> m_veCompactIndices;
+		std::vector<BIAS_TYPE>		m_veCompactBiases;
+		std::vector<WEIGHT_TYPE>	m_veCompactWeights;
+		std::vector<unsigned int>	m_veMutations;
+		std::vector<float>			m_veMutationValues;
 
 	private:
-		//resizing arrays efficiently
-		bool ResizeNeuronVector(VECTOR_NEURON_ALLELE &vector, const unsigned int nNewSize) const;
+		//making the shared blocks unique before changing them, either keeping their contents or
+		//starting from an empty block when the contents are overwritten anyway
+		void UnshareTopology(const bool bKeep);
+		void UnshareParameters(const bool bKeep);
 
-		//dynamically allocating elements and releasing elements
-		static NeuronAllele* CreateNeuronAllele();
-		static NeuronAllele* CreateNeuronAllele(const NeuronAllele &allele);
-		static void ReleaseNeuronAllele(NeuronAllele *pAllele);
+		//resizing and clearing the neurons
+		void Resize(const unsigned int nInput, const unsigned int nOutput, const unsigned int nHidden);
+		void Clear();
 
-		void ReleaseAll();
+		//writing and reading the binary format. All values are little-endian, after the header
+		//the neurons follow in storage order (input, hidden and output) as delta encoded global
+		//indices, names, bit packed types and biases. Next are the connections of the input and
+		//hidden neurons: delta encoded indices and the storage positions of the connected
+		//neurons, followed by the bit packed slots and the weights
+		void WriteStorage(StorageWriter &writer) const;
+		bool ReadStorage(StorageReader &reader);
+		unsigned int GetStorageNeuron(const unsigned int nPosition) const;
+		unsigned int GetStoragePosition(const unsigned int nNeuron) const;
 
 		//reducing code redundancy
 		// - recombining neuron allele properties from parents
-		static void RecombineNeuronAllele(NeuronAllele *pTarget, NeuronAllele *pParentChampion, NeuronAllele *pParent);
-		static void RecombineNeuronAlleleConnections(NeuronAllele *pTarget, NeuronAllele *pParentChampion, NeuronAllele *pParent, const std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> &map);
-		
-		// - create neuron allele properties from a source RNA neuron allele
-		static void CreateNeuronAlleleConnections(NeuronAllele *pTarget, NeuronAllele * pSource, const std::map<GLOBAL_INDEX_TYPE, NeuronAllele*> &map);
-		
-		// - constructing, adding and removing from the neuron allele connection sets
-		static void CreateNeuronConnectionSets(NeuronAllele *pNew, const NeuronAllele * const pPrev);
-		static void AddToNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele * const pNew);
-		static void AddToNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele::SET_CONNECTED_NEURONS &toAdd);
-		static void RemoveFromNeuronConnectionSets(NeuronAllele *pToProcess, const NeuronAllele * const pRemoved);
-		
+		void RecombineNeuronAllele(const unsigned int nTarget, const RNA &parentChampion, const RNA &parent, const unsigned int nParent);
+		void RecombineNeuronAlleleConnections(const unsigned int nTarget, const RNA &parentChampion, const NeuronAllele &champion, const RNA &parent, const NeuronAllele *pParent);
+
+		// - locating connection alleles and keeping them sorted, and compacting the arrays after
+		// they have been mutated
+		unsigned int FindConnectionAllele(const unsigned int nNeuron, const GLOBAL_INDEX_TYPE nIndex) const;
+		void InsertConnectionAllele(const unsigned int nNeuron, const ConnectionAllele &connection, const WEIGHT_TYPE fWeight);
+		void EraseConnectionAllele(const unsigned int nNeuron, const unsigned int nPosition);
+		bool IsConnected(const unsigned int nSource, const unsigned int nTarget) const;
+		void Compact();
+		bool RebuildEdgeIndex();
+
+		// - maintaining the topological order of the neuron alleles, which prevents value loops.
+		// Adding a connection updates the order incrementally (Pearce-Kelly), only the neurons in
+		// between the two connected neurons are searched when they are in the wrong order
+		bool RebuildTopologicalOrder();
+		void InsertTopologicalOrder(const unsigned int nFirstNew);
+		void RemoveTopologicalOrder(const std::vector<LOCAL_INDEX_TYPE> &veRemoved);
+		bool OrderConnection(const unsigned int nSource, const unsigned int nTarget);
+		unsigned int GetNewVisit();
+
+		// - hashing the genes, either a single gene, the genes selected to mutate or all of them
+		unsigned long long HashNeuron(const unsigned int nNeuron) const;
+		unsigned long long HashConnection(const unsigned int nPosition) const;
+		unsigned long long HashMutatedNeurons(const unsigned int nFirst) const;
+		unsigned long long HashMutatedConnections() const;
+		unsigned long long ComputeHash() const;
+
 		// - simple neuron allele mutations (weight/bias/etc.) and the more complex ones (adding
 		// a connection or neuron, and removing a neuron)
-		static void MutateNeuronAlleleProperties(NeuronAllele* const pToMutate, const RNAMutationRates &rates);
-		void MutateConnectionAlleleAddNeuron(ConnectionAllele* const pToMutate, std::vector<NeuronMutation> &prevMutations);
-		void MutateNeuronAlleleRemoveNeuron(NeuronAllele* const pToMutate, std::vector<ConnectionMutation> &prevMutations);
-		static void MutateNeuronAlleleAddConnection(NeuronAllele* pSource, NeuronAllele* const pTarget, std::vector<ConnectionMutation> &prevMutations);
+		void MutateProperties(RNAMutationSamplers &samplers);
+		unsigned int SelectMutations(MutationSampler &sampler, const unsigned int nCount);
+		void MutateConnectionAlleleAddNeuron(const unsigned int nSource, const GLOBAL_INDEX_TYPE nConnection, InnovationRegistry &innovations);
+		void MutateNeuronAlleleRemoveNeuron(const unsigned int nRemoved, InnovationRegistry &innovations);
+		void MutateNeuronAlleleAddConnection(const unsigned int nSource, const unsigned int nTarget, InnovationRegistry &innovations);
 	};
 }
 
@@ -1,30 +1,283 @@
 #include "FENNRandom.h"
-#include <cstdlib> //for RAND_MAX
 
-#include <random>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+	//the seed shared by all threads, changing the seed generation forces all threads to reseed
+	std::atomic<unsigned int> g_nSeed(0);
+	std::atomic<unsigned int> g_nSeedGeneration(1);
+	std::atomic<unsigned int> g_nThreadCount(0);
+
+	//the engine of the current thread
+	struct ThreadRandom
+	{
+		fenn::RandomEngine		engine;
+		unsigned int			nSeedGeneration;
+	};
+
+	FENN_THREAD_LOCAL ThreadRandom g_thread;
+
+	inline unsigned long long RotateLeft(const unsigned long long x, const int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	inline unsigned long long SplitMix64(unsigned long long &nState)
+	{
+		unsigned long long z = (nState += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	inline float ToContinuous(const unsigned long long nRandom)
+	{
+		//use the upper 24 bits, such that every value is exactly representable in [0, 1)
+		return (float)(nRandom >> 40) * (1.0f / 16777216.0f);
+	}
+}
+
+void fenn::RandomEngine::Seed(const unsigned long long nSeed, const unsigned long long nStream)
+{
+	//expand the seed and stream into the full state using SplitMix64, as recommended for
+	//xoshiro generators. The stream is mixed separately to avoid the sequences of (seed,
+	//stream) and (seed + 1, stream - 1) being related
+	unsigned long long nMix = nStream;
+	unsigned long long nState = nSeed ^ SplitMix64(nMix);
+
+	for (unsigned int i = 0; i < 4; i++) {
+		m_pState[i] = SplitMix64(nState);
+	}
+}
+
+unsigned long long fenn::RandomEngine::Next()
+{
+	const unsigned long long nResult = RotateLeft(m_pState[0] + m_pState[3], 23) + m_pState[0];
+	const unsigned long long t = m_pState[1] << 17;
+
+	m_pState[2] ^= m_pState[0];
+	m_pState[3] ^= m_pState[1];
+	m_pState[1] ^= m_pState[2];
+	m_pState[0] ^= m_pState[3];
+	m_pState[2] ^= t;
+	m_pState[3] = RotateLeft(m_pState[3], 45);
+
+	return nResult;
+}
+
+unsigned int fenn::RandomEngine::NextInteger()
+{
+	return (unsigned int)(Next() >> 32);
+}
+
+unsigned int fenn::RandomEngine::NextInteger(const unsigned int nMax)
+{
+	//scale the upper 32 bits instead of using a modulo, which is both faster and less biased
+	return (unsigned int)(((Next() >> 32) * nMax) >> 32);
+}
+
+bool fenn::RandomEngine::NextBinary()
+{
+	return (Next() >> 63) != 0;
+}
+
+CHANCE_TYPE fenn::RandomEngine::NextContinuous()
+{
+	return (CHANCE_TYPE)ToContinuous(Next());
+}
+
+float fenn::RandomEngine::NextContinuous(const float fMin, const float fMax)
+{
+	return ToContinuous(Next()) * (fMax - fMin) + fMin;
+}
+
+void fenn::RandomEngine::FillContinuous(float *pTarget, const unsigned int nCount, const float fMin, const float fMax)
+{
+	//keep the state in local variables, such that the compiler can keep it in registers for the
+	//entire loop
+	unsigned long long s0 = m_pState[0], s1 = m_pState[1], s2 = m_pState[2], s3 = m_pState[3];
+	const float fRange = fMax - fMin;
+
+	for (unsigned int i = 0; i < nCount; i++) {
+		const unsigned long long nResult = RotateLeft(s0 + s3, 23) + s0;
+		const unsigned long long t = s1 << 17;
+
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = RotateLeft(s3, 45);
+
+		pTarget[i] = ToContinuous(nResult) * fRange + fMin;
+	}
+
+	m_pState[0] = s0;
+	m_pState[1] = s1;
+	m_pState[2] = s2;
+	m_pState[3] = s3;
+}
+
+void fenn::RandomEngine::Jump()
+{
+	static const unsigned long long pJump[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+	Jump(pJump);
+}
+
+void fenn::RandomEngine::LongJump()
+{
+	static const unsigned long long pLongJump[4] = { 0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL };
+	Jump(pLongJump);
+}
+
+void fenn::RandomEngine::Jump(const unsigned long long pPolynomial[4])
+{
+	unsigned long long pState[4] = { 0, 0, 0, 0 };
+
+	for (unsigned int i = 0; i < 4; i++) {
+		for (unsigned int b = 0; b < 64; b++) {
+			if (pPolynomial[i] & (1ULL << b)) {
+				pState[0] ^= m_pState[0];
+				pState[1] ^= m_pState[1];
+				pState[2] ^= m_pState[2];
+				pState[3] ^= m_pState[3];
+			}
+
+			Next();
+		}
+	}
+
+	for (unsigned int i = 0; i < 4; i++) {
+		m_pState[i] = pState[i];
+	}
+}
+
+fenn::ScopedRandomStream::ScopedRandomStream(const unsigned long long nSeed, const unsigned long long nStream)
+	: m_previous(GetThreadRandomEngine())
+{
+	GetThreadRandomEngine().Seed(nSeed, nStream);
+}
+
+fenn::ScopedRandomStream::~ScopedRandomStream()
+{
+	g_thread.engine = m_previous;
+}
+
+fenn::MutationSampler::MutationSampler(const CHANCE_TYPE fChance, const MutationSampling eSampling)
+	: m_fChance(fChance)
+	, m_eSampling(eSampling)
+	, m_fLogInverseChance(fChance < 1 ? log(1.0 - (double)fChance) : 0)
+	, m_nSkip(0)
+{
+	if (m_eSampling == MUTATIONSAMPLING_GEOMETRIC) {
+		m_nSkip = DrawSkip();
+	}
+}
+
+bool fenn::MutationSampler::Sample()
+{
+	if (m_eSampling == MUTATIONSAMPLING_BERNOULLI) {
+		return GetRandomContinuous() < m_fChance;
+	}
+
+	//count down the genes until the next mutation, and only then draw the next distance
+	if (m_nSkip > 0) {
+		m_nSkip--;
+		return false;
+	}
+
+	m_nSkip = DrawSkip();
+	return true;
+}
+
+unsigned long long fenn::MutationSampler::Skip(const unsigned long long nRemaining)
+{
+	//draw for every gene until one mutates, or until no genes remain
+	if (m_eSampling == MUTATIONSAMPLING_BERNOULLI) {
+		for (unsigned long long i = 0; i < nRemaining; i++) {
+			if (GetRandomContinuous() < m_fChance) {
+				return i;
+			}
+		}
+
+		return nRemaining;
+	}
+
+	//the gene following the skipped genes mutates, the distance is drawn regardless of the
+	//number of remaining genes
+	const unsigned long long nSkip = m_nSkip;
+	m_nSkip = DrawSkip();
+	return nSkip;
+}
+
+unsigned long long fenn::MutationSampler::DrawSkip() const
+{
+	//chances outside (0, 1) do not require any random numbers
+	if (m_fChance <= 0) {
+		return ~0ULL;
+	} else if (m_fChance >= 1) {
+		return 0;
+	}
+
+	//invert the cumulative geometric distribution using a uniform number in (0, 1] with full
+	//double precision
+	const double fUniform = (double)((GetThreadRandomEngine().Next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+	const double fSkip = floor(log(fUniform) / m_fLogInverseChance);
+	return fSkip < 1.8e19 ? (unsigned long long)fSkip : ~0ULL;
+}
 
 void fenn::InitializeRandom(const unsigned int nSeed)
 {
-	srand(nSeed);
+	g_nSeed.store(nSeed);
+	g_nThreadCount.store(0);
+	g_nSeedGeneration.fetch_add(1);
 }
 
 void fenn::ReleaseRandom()
 {
-	//this function doesn't do anything. But perhaps, if I would implement
-	//C++11-like random number generators, this will be useful
+	//this function doesn't do anything, the per-thread engines don't own any resources
+}
+
+fenn::RandomEngine& fenn::GetThreadRandomEngine()
+{
+	if (g_thread.nSeedGeneration != g_nSeedGeneration.load(std::memory_order_relaxed)) {
+		//first use of the engine since seeding, move to the substream of this thread
+		const unsigned int nThread = g_nThreadCount.fetch_add(1);
+		g_thread.engine.Seed(g_nSeed.load());
+
+		for (unsigned int i = 0; i < nThread; i++) {
+			g_thread.engine.Jump();
+		}
+
+		g_thread.nSeedGeneration = g_nSeedGeneration.load();
+	}
+
+	return g_thread.engine;
 }
 
 unsigned int fenn::GetRandom()
 {
-	return rand();
+	return GetThreadRandomEngine().NextInteger();
+}
+
+unsigned int fenn::GetRandom(const unsigned int nMax)
+{
+	return GetThreadRandomEngine().NextInteger(nMax);
 }
 
 bool fenn::GetRandomBinary()
 {
-	return (rand() > ((RAND_MAX - 1) >> 2));
+	return GetThreadRandomEngine().NextBinary();
 }
 
 CHANCE_TYPE fenn::GetRandomContinuous()
 {
-	return (CHANCE_TYPE)(rand()) / RAND_MAX;
+	return GetThreadRandomEngine().NextContinuous();
+}
+
+void fenn::FillRandomContinuous(float *pTarget, const unsigned int nCount, const float fMin, const float fMax)
+{
+	GetThreadRandomEngine().FillContinuous(pTarget, nCount, fMin, fMax);
 }
\ No newline at end of file
@@ -3,14 +3,136 @@
 
 #include "FENNConfig.h"
 
+//the maximum value returned by GetRandom()
+#define RANDOM_MAX (unsigned int)(0xFFFFFFFF)
+
 namespace fenn
 {
+	//----------------------------------------------------------------
+	// Class - RandomEngine
+	//----------------------------------------------------------------
+	// A xoshiro256++ random number generator. The engine is a plain
+	// structure without constructors, such that it can be stored in
+	// thread local storage on every compiler. Seed(...) should be
+	// called before the engine is used. Engines seeded with the same
+	// seed but a different stream produce independent sequences,
+	// which can be used to give every genome its own sequence. Jump()
+	// advances the engine by 2^128 numbers, such that jumping a copy
+	// of an engine n times results in n non-overlapping substreams.
+	//----------------------------------------------------------------
+	class RandomEngine
+	{
+	public:
+		//seeding the engine
+		void Seed(const unsigned long long nSeed, const unsigned long long nStream = 0);
+
+		//retrieving random numbers
+		unsigned long long Next();
+		unsigned int NextInteger();
+		unsigned int NextInteger(const unsigned int nMax); //in [0, nMax)
+		bool NextBinary();
+		CHANCE_TYPE NextContinuous(); //in [0, 1)
+		float NextContinuous(const float fMin, const float fMax); //in [fMin, fMax)
+
+		//filling arrays with uniformly distributed values in [fMin, fMax)
+		void FillContinuous(float *pTarget, const unsigned int nCount, const float fMin, const float fMax);
+
+		//advancing the engine by 2^128 and 2^192 numbers respectively
+		void Jump();
+		void LongJump();
+
+	protected:
+		unsigned long long		m_pState[4];
+
+	private:
+		void Jump(const unsigned long long pPolynomial[4]);
+	};
+
+	//----------------------------------------------------------------
+	// Class - ScopedRandomStream
+	//----------------------------------------------------------------
+	// Temporarily replaces the engine of the calling thread by the
+	// stream with the given seed and stream index. All random numbers
+	// drawn by the thread while the object exists come from that
+	// stream, after which the thread's engine is restored. This makes
+	// the random numbers used for a genome independent of the thread
+	// processing it.
+	//----------------------------------------------------------------
+	class ScopedRandomStream
+	{
+	public:
+		ScopedRandomStream(const unsigned long long nSeed, const unsigned long long nStream);
+		~ScopedRandomStream();
+
+	private:
+		RandomEngine			m_previous;
+
+		ScopedRandomStream(const ScopedRandomStream &stream);
+		void operator = (const ScopedRandomStream &stream);
+	};
+
+	//----------------------------------------------------------------
+	// Enumeration - MutationSampling
+	//----------------------------------------------------------------
+	// The manner in which a MutationSampler decides which genes of a
+	// sequence mutate.
+	//		- Bernoulli: a random number is drawn for every gene.
+	//		- Geometric: the number of genes until the next mutation is
+	//			drawn from a geometric distribution, such that a random
+	//			number is only drawn for every mutation.
+	// Both result in exactly the same distribution of mutations.
+	//----------------------------------------------------------------
+	enum MutationSampling
+	{
+		MUTATIONSAMPLING_BERNOULLI = 0,
+		MUTATIONSAMPLING_GEOMETRIC = 1,
+	};
+
+	//----------------------------------------------------------------
+	// Class - MutationSampler
+	//----------------------------------------------------------------
+	// Decides for a sequence of genes which genes mutate, every gene
+	// mutating independently with the given chance. Sample() should
+	// be called once for every gene in the sequence. Alternatively
+	// Skip(n) returns the number of genes that do not mutate before
+	// the next mutating gene, given that n genes remain. A result of
+	// at least n means none of the remaining genes mutates. Geometric
+	// sampling skips the genes entirely, whereas Bernoulli sampling
+	// still draws once for every skipped gene. The sampler uses the
+	// random number engine of the calling thread.
+	//----------------------------------------------------------------
+	class MutationSampler
+	{
+	public:
+		MutationSampler(const CHANCE_TYPE fChance, const MutationSampling eSampling);
+
+		bool Sample();
+		unsigned long long Skip(const unsigned long long nRemaining);
+
+	protected:
+		CHANCE_TYPE				m_fChance;
+		MutationSampling		m_eSampling;
+		double					m_fLogInverseChance; //log(1 - chance)
+		unsigned long long		m_nSkip; //remaining genes before the next mutation (geometric only)
+
+	private:
+		unsigned long long DrawSkip() const;
+	};
+
+	//Every thread uses its own engine, such that these functions can be called from multiple
+	//threads simultaneously. The engine of a thread is seeded on first use with the seed passed
+	//to InitializeRandom(...), after which it is jumped once for every thread that requested
+	//an engine before it. As a result the threads use non-overlapping substreams.
 	void InitializeRandom(const unsigned int nSeed);
 	void ReleaseRandom();
 
+	RandomEngine& GetThreadRandomEngine();
+
 	unsigned int GetRandom();
+	unsigned int GetRandom(const unsigned int nMax); //in [0, nMax)
 	bool GetRandomBinary();
 	CHANCE_TYPE GetRandomContinuous();
+	void FillRandomContinuous(float *pTarget, const unsigned int nCount, const float fMin, const float fMax);
 };
 
 #endif
\ No newline at end of file
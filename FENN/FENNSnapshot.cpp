@@ -0,0 +1,312 @@
+#include "FENNSnapshot.h"
+#include "FENNRNA.h"
+#include "FENNStorage.h"
+#include "FENNWorld.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	//the identification and version of the snapshot format. The header is followed by the
+	//offset table, which contains one more entry than the number of genomes: the end of the
+	//last genome
+	const unsigned char SNAPSHOT_MAGIC[4] = { 'F', 'P', 'O', 'P' };
+	const unsigned int SNAPSHOT_VERSION = 1;
+	const unsigned int SNAPSHOT_HEADER_SIZE = 32;
+	const unsigned int SNAPSHOT_OFFSET_SIZE = 8;
+
+	FILE* OpenFileForWriting(const char *sFile)
+	{
+	#if defined(_MSC_VER)
+		FILE *pFile = NULL;
+		return fopen_s(&pFile, sFile, "wb") == 0 ? pFile : NULL;
+	#else
+		return fopen(sFile, "wb");
+	#endif
+	}
+
+	inline bool WriteToFile(FILE *pFile, const unsigned char *pData, const size_t nSize)
+	{
+		return nSize == 0 || fwrite(pData, 1, nSize, pFile) == nSize;
+	}
+}
+
+fenn::PopulationSnapshot::PopulationSnapshot()
+	: m_pData(NULL)
+	, m_nSize(0)
+	, m_nGenomes(0)
+	, m_nChampion(SNAPSHOT_NO_CHAMPION)
+	, m_nNeuronIndexCounter(0)
+	, m_nConnectionIndexCounter(0)
+{
+}
+
+fenn::PopulationSnapshot::~PopulationSnapshot()
+{
+	Close();
+}
+
+bool fenn::PopulationSnapshot::Save(const char *sFile, const RNA * const *ppGenomes, const unsigned int nGenomes, const FITNESS_TYPE *pFitness)
+{
+	//the champion is the genome with the highest fitness
+	unsigned int nChampion = SNAPSHOT_NO_CHAMPION;
+
+	if (pFitness) {
+		for (unsigned int i = 0; i < nGenomes; i++) {
+			if (nChampion == SNAPSHOT_NO_CHAMPION || pFitness[i] > pFitness[nChampion]) {
+				nChampion = i;
+			}
+		}
+	}
+
+	FILE *pFile = OpenFileForWriting(sFile);
+
+	if (!pFile) {
+		return false;
+	}
+
+	//write the header, followed by an empty offset table which is filled once all genomes have
+	//been written. This way every genome only has to be encoded once
+	const unsigned long long nTableSize = ((unsigned long long)nGenomes + 1) * SNAPSHOT_OFFSET_SIZE;
+	std::vector<unsigned char> veBuffer(SNAPSHOT_HEADER_SIZE);
+	StorageWriter header(veBuffer.data(), SNAPSHOT_HEADER_SIZE);
+	header.WriteBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.WriteUInt32(SNAPSHOT_VERSION);
+	header.WriteUInt32(nGenomes);
+	header.WriteUInt32(nChampion);
+	header.WriteUInt64(world_single::Get().GetNeuronIndexCounter());
+	header.WriteUInt64(world_single::Get().GetConnectionIndexCounter());
+	assert(header.IsValid() && header.GetSize() == SNAPSHOT_HEADER_SIZE);
+
+	bool bSuccess = WriteToFile(pFile, veBuffer.data(), SNAPSHOT_HEADER_SIZE);
+	std::vector<unsigned char> veTable((size_t)nTableSize, 0);
+	bSuccess = bSuccess && WriteToFile(pFile, veTable.data(), veTable.size());
+
+	//write the genomes, reusing the buffer. Only when a genome does not fit the buffer its size
+	//is determined and the buffer enlarged
+	StorageWriter table(veTable.data(), (unsigned int)veTable.size());
+	unsigned long long nOffset = SNAPSHOT_HEADER_SIZE + nTableSize;
+
+	for (unsigned int i = 0; i < nGenomes && bSuccess; i++) {
+		table.WriteUInt64(nOffset);
+		unsigned int nSize;
+
+		if (!ppGenomes[i]->Save(veBuffer.data(), veBuffer.size(), &nSize)) {
+			veBuffer.resize(ppGenomes[i]->GetStorageSize());
+			bSuccess = ppGenomes[i]->Save(veBuffer.data(), veBuffer.size(), &nSize);
+		}
+
+		bSuccess = bSuccess && WriteToFile(pFile, veBuffer.data(), nSize);
+		nOffset += nSize;
+	}
+
+	table.WriteUInt64(nOffset);
+
+	//fill the offset table
+	bSuccess = bSuccess && table.IsValid() && fseek(pFile, SNAPSHOT_HEADER_SIZE, SEEK_SET) == 0;
+	bSuccess = bSuccess && WriteToFile(pFile, veTable.data(), veTable.size());
+	bSuccess = fclose(pFile) == 0 && bSuccess;
+	return bSuccess;
+}
+
+bool fenn::PopulationSnapshot::Save(const char *sFile, const std::vector<RNA> &vePopulation, const std::vector<FITNESS_TYPE> &veFitness)
+{
+	//the fitness values are optional
+	assert(veFitness.empty() || veFitness.size() == vePopulation.size());
+	std::vector<const RNA*> veGenomes(vePopulation.size());
+
+	for (unsigned int i = 0; i < vePopulation.size(); i++) {
+		veGenomes[i] = &vePopulation[i];
+	}
+
+	return Save(sFile, veGenomes.data(), veGenomes.size(), veFitness.empty() ? NULL : veFitness.data());
+}
+
+bool fenn::PopulationSnapshot::Open(const char *sFile)
+{
+	Close();
+
+	if (!MapFile(sFile)) {
+		return false;
+	}
+
+	//only the header is validated, the offsets are validated when a genome is accessed such
+	//that opening the snapshot doesn't touch the entire offset table
+	StorageReader header(m_pData, m_nSize < SNAPSHOT_HEADER_SIZE ? (unsigned int)m_nSize : SNAPSHOT_HEADER_SIZE);
+	unsigned char aMagic[sizeof(SNAPSHOT_MAGIC)];
+	header.ReadBytes(aMagic, sizeof(aMagic));
+	const unsigned int nVersion = header.ReadUInt32();
+	m_nGenomes = header.ReadUInt32();
+	m_nChampion = header.ReadUInt32();
+	const unsigned long long nNeuronIndexCounter = header.ReadUInt64();
+	const unsigned long long nConnectionIndexCounter = header.ReadUInt64();
+
+	if (!header.IsValid() || memcmp(aMagic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || nVersion != SNAPSHOT_VERSION ||
+		(m_nChampion != SNAPSHOT_NO_CHAMPION && m_nChampion >= m_nGenomes) ||
+		nNeuronIndexCounter > (GLOBAL_INDEX_TYPE)(~0) || nConnectionIndexCounter > (GLOBAL_INDEX_TYPE)(~0) ||
+		SNAPSHOT_HEADER_SIZE + ((unsigned long long)m_nGenomes + 1) * SNAPSHOT_OFFSET_SIZE > m_nSize) {
+		Close();
+		return false;
+	}
+
+	m_nNeuronIndexCounter = (GLOBAL_INDEX_TYPE)nNeuronIndexCounter;
+	m_nConnectionIndexCounter = (GLOBAL_INDEX_TYPE)nConnectionIndexCounter;
+	return true;
+}
+
+void fenn::PopulationSnapshot::Close()
+{
+	UnmapFile();
+	m_nGenomes = 0;
+	m_nChampion = SNAPSHOT_NO_CHAMPION;
+	m_nNeuronIndexCounter = 0;
+	m_nConnectionIndexCounter = 0;
+}
+
+bool fenn::PopulationSnapshot::IsOpen() const
+{
+	return m_pData != NULL;
+}
+
+unsigned int fenn::PopulationSnapshot::GetNumGenomes() const
+{
+	return m_nGenomes;
+}
+
+unsigned int fenn::PopulationSnapshot::GetChampion() const
+{
+	return m_nChampion;
+}
+
+GLOBAL_INDEX_TYPE fenn::PopulationSnapshot::GetNeuronIndexCounter() const
+{
+	return m_nNeuronIndexCounter;
+}
+
+GLOBAL_INDEX_TYPE fenn::PopulationSnapshot::GetConnectionIndexCounter() const
+{
+	return m_nConnectionIndexCounter;
+}
+
+void fenn::PopulationSnapshot::RestoreWorld() const
+{
+	//never move the counters backwards, the world may already have handed out larger indices
+	World &world = world_single::Get();
+
+	if (world.GetNeuronIndexCounter() < m_nNeuronIndexCounter) {
+		world.SetNeuronIndexCounter(m_nNeuronIndexCounter);
+	}
+
+	if (world.GetConnectionIndexCounter() < m_nConnectionIndexCounter) {
+		world.SetConnectionIndexCounter(m_nConnectionIndexCounter);
+	}
+}
+
+bool fenn::PopulationSnapshot::LoadGenome(const unsigned int iGenome, RNA &genome) const
+{
+	unsigned int nSize;
+	const unsigned char *pData = GetGenomeData(iGenome, nSize);
+	return pData != NULL && genome.Load(pData, nSize);
+}
+
+const unsigned char* fenn::PopulationSnapshot::GetGenomeData(const unsigned int iGenome, unsigned int &nSize) const
+{
+	if (iGenome >= m_nGenomes) {
+		nSize = 0;
+		return NULL;
+	}
+
+	//the genome lies between its own offset and the offset of the next genome
+	const unsigned long long nBegin = GetGenomeOffset(iGenome);
+	const unsigned long long nEnd = GetGenomeOffset(iGenome + 1);
+	const unsigned long long nTableEnd = SNAPSHOT_HEADER_SIZE + ((unsigned long long)m_nGenomes + 1) * SNAPSHOT_OFFSET_SIZE;
+
+	if (nBegin < nTableEnd || nBegin > nEnd || nEnd > m_nSize || nEnd - nBegin > (unsigned int)(~0)) {
+		nSize = 0;
+		return NULL;
+	}
+
+	nSize = (unsigned int)(nEnd - nBegin);
+	return m_pData + (size_t)nBegin;
+}
+
+bool fenn::PopulationSnapshot::MapFile(const char *sFile)
+{
+#if defined(_WIN32)
+	HANDLE hFile = CreateFileA(sFile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER nFileSize;
+	HANDLE hMapping = NULL;
+
+	if (GetFileSizeEx(hFile, &nFileSize) && nFileSize.QuadPart > 0 && (unsigned long long)nFileSize.QuadPart <= (size_t)(~0)) {
+		hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+
+	//the view keeps the file mapped, hence both handles can be closed directly
+	if (hMapping) {
+		m_pData = (const unsigned char*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		m_nSize = m_pData ? (unsigned long long)nFileSize.QuadPart : 0;
+		CloseHandle(hMapping);
+	}
+
+	CloseHandle(hFile);
+#else
+	const int nFile = open(sFile, O_RDONLY);
+
+	if (nFile < 0) {
+		return false;
+	}
+
+	struct stat status;
+
+	if (fstat(nFile, &status) == 0 && status.st_size > 0 && (unsigned long long)status.st_size <= (size_t)(~0)) {
+		void* const pMapped = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, nFile, 0);
+
+		if (pMapped != MAP_FAILED) {
+			m_pData = (const unsigned char*)pMapped;
+			m_nSize = (unsigned long long)status.st_size;
+		}
+	}
+
+	//the mapping keeps the file open
+	close(nFile);
+#endif
+
+	return m_pData != NULL;
+}
+
+void fenn::PopulationSnapshot::UnmapFile()
+{
+	if (m_pData) {
+	#if defined(_WIN32)
+		UnmapViewOfFile(m_pData);
+	#else
+		munmap((void*)m_pData, (size_t)m_nSize);
+	#endif
+		m_pData = NULL;
+		m_nSize = 0;
+	}
+}
+
+unsigned long long fenn::PopulationSnapshot::GetGenomeOffset(const unsigned int iEntry) const
+{
+	StorageReader reader(m_pData + SNAPSHOT_HEADER_SIZE + (size_t)iEntry * SNAPSHOT_OFFSET_SIZE, SNAPSHOT_OFFSET_SIZE);
+	return reader.ReadUInt64();
+}
\ No newline at end of file
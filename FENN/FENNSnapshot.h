@@ -0,0 +1,76 @@
+#ifndef FENN_SNAPSHOT_H
+#define FENN_SNAPSHOT_H
+
+#include "FENNConfig.h"
+
+#include <vector>
+
+namespace fenn
+{
+	//forward definitions
+	class RNA;
+
+	//----------------------------------------------------------------
+	// Class - PopulationSnapshot
+	//----------------------------------------------------------------
+	// A file containing an entire population. The file starts with a
+	// header, specifying the number of genomes, the index of the
+	// champion (if known) and the index counters of the world,
+	// followed by a table with the offset of every genome within the
+	// file. The genomes themselves are stored in the binary format of
+	// the RNA class. Opening a snapshot maps the file into memory
+	// without reading it, a genome is only decoded when it is loaded.
+	// Hence opening a snapshot of a large population is cheap, and
+	// loading only the champion only touches the pages of the header,
+	// the offset table and the champion itself. Saving is done in a
+	// single pass through the population, using a single buffer.
+	//----------------------------------------------------------------
+	class PopulationSnapshot
+	{
+	public:
+		//constructor and destructor
+		PopulationSnapshot();
+		~PopulationSnapshot();
+
+		//saving a population, the fitness is optional and only used to determine the champion
+		static bool Save(const char *sFile, const RNA * const *ppGenomes, const unsigned int nGenomes, const FITNESS_TYPE *pFitness);
+		static bool Save(const char *sFile, const std::vector<RNA> &vePopulation, const std::vector<FITNESS_TYPE> &veFitness);
+
+		//opening and closing a saved population
+		bool Open(const char *sFile);
+		void Close();
+		bool IsOpen() const;
+
+		//inspecting the saved population
+		unsigned int GetNumGenomes() const;
+		unsigned int GetChampion() const; //returns SNAPSHOT_NO_CHAMPION if unknown
+		GLOBAL_INDEX_TYPE GetNeuronIndexCounter() const;
+		GLOBAL_INDEX_TYPE GetConnectionIndexCounter() const;
+
+		//continuing the saved population, such that new indices do not collide with saved ones
+		void RestoreWorld() const;
+
+		//decoding a single genome, or retrieving its encoded data
+		bool LoadGenome(const unsigned int iGenome, RNA &genome) const;
+		const unsigned char* GetGenomeData(const unsigned int iGenome, unsigned int &nSize) const;
+
+	protected:
+		const unsigned char		*m_pData;
+		unsigned long long		m_nSize;
+
+		unsigned int			m_nGenomes;
+		unsigned int			m_nChampion;
+		GLOBAL_INDEX_TYPE		m_nNeuronIndexCounter;
+		GLOBAL_INDEX_TYPE		m_nConnectionIndexCounter;
+
+	private:
+		PopulationSnapshot(const PopulationSnapshot &snapshot);
+		void operator = (const PopulationSnapshot &snapshot);
+
+		bool MapFile(const char *sFile);
+		void UnmapFile();
+		unsigned long long GetGenomeOffset(const unsigned int iEntry) const;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "FENNSpecies.h"
+#include "FENNRandom.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	//the species of a genome which does not belong to any species yet
+	const unsigned int SPECIES_NONE = ~0u;
+
+	inline bool CompareIndexToConnection(const GLOBAL_INDEX_TYPE nIndex, const fenn::ConnectionAllele &connection)
+	{
+		return nIndex < connection.nIndex;
+	}
+
+	//the number of connection genes of a genome and the largest connection index, the connections
+	//of every neuron are sorted by their index
+	void GetConnectionGenes(const fenn::RNA &genome, unsigned int &nCount, GLOBAL_INDEX_TYPE &nMax)
+	{
+		nCount = 0;
+		nMax = 0;
+
+		for (unsigned int i = 0; i < genome.GetNumNeurons(); i++) {
+			const fenn::NeuronAllele &neuron = genome.GetNeuron(i);
+
+			if (neuron.nNumConnections > 0) {
+				nCount += neuron.nNumConnections;
+				nMax = std::max(nMax, genome.GetConnections(neuron)[neuron.nNumConnections - 1].nIndex);
+			}
+		}
+	}
+
+	//unmatched genes with an index beyond the largest index of the other genome are excess
+	//genes, the remaining unmatched genes are disjoint genes. As the connections are sorted, the
+	//excess genes of a range of connections are the last ones
+	inline void CountUnmatched(const fenn::ConnectionAllele *pConnections, const unsigned int nCount, const GLOBAL_INDEX_TYPE nOtherMax, unsigned int &nExcess, unsigned int &nDisjoint)
+	{
+		const fenn::ConnectionAllele* const pExcess = std::upper_bound(pConnections, pConnections + nCount, nOtherMax, CompareIndexToConnection);
+		nExcess += (pConnections + nCount) - pExcess;
+		nDisjoint += pExcess - pConnections;
+	}
+
+	void CompareConnections(const fenn::RNA &first, const fenn::NeuronAllele &firstNeuron, const GLOBAL_INDEX_TYPE nFirstMax,
+		const fenn::RNA &second, const fenn::NeuronAllele &secondNeuron, const GLOBAL_INDEX_TYPE nSecondMax,
+		unsigned int &nExcess, unsigned int &nDisjoint, std::vector<WEIGHT_TYPE> &veFirst, std::vector<WEIGHT_TYPE> &veSecond)
+	{
+		//merge the connections of two matching neurons by their index, gathering the weights of the
+		//matching connections
+		const fenn::ConnectionAllele* const pFirst = first.GetConnections(firstNeuron);
+		const fenn::ConnectionAllele* const pSecond = second.GetConnections(secondNeuron);
+		const WEIGHT_TYPE* const pFirstWeights = first.GetWeights(firstNeuron);
+		const WEIGHT_TYPE* const pSecondWeights = second.GetWeights(secondNeuron);
+		unsigned int iFirst = 0;
+		unsigned int iSecond = 0;
+
+		while (iFirst < firstNeuron.nNumConnections && iSecond < secondNeuron.nNumConnections) {
+			if (pFirst[iFirst].nIndex == pSecond[iSecond].nIndex) {
+				veFirst.push_back(pFirstWeights[iFirst++]);
+				veSecond.push_back(pSecondWeights[iSecond++]);
+			} else if (pFirst[iFirst].nIndex < pSecond[iSecond].nIndex) {
+				CountUnmatched(&pFirst[iFirst++], 1, nSecondMax, nExcess, nDisjoint);
+			} else {
+				CountUnmatched(&pSecond[iSecond++], 1, nFirstMax, nExcess, nDisjoint);
+			}
+		}
+
+		CountUnmatched(pFirst + iFirst, firstNeuron.nNumConnections - iFirst, nSecondMax, nExcess, nDisjoint);
+		CountUnmatched(pSecond + iSecond, secondNeuron.nNumConnections - iSecond, nFirstMax, nExcess, nDisjoint);
+	}
+
+	//the sum of the absolute differences, computed using four partial sums. These are independent
+	//of each other, such that the compiler can keep them in a single vector register
+	float SumAbsoluteDifferences(const WEIGHT_TYPE *pFirst, const WEIGHT_TYPE *pSecond, const unsigned int nCount)
+	{
+		float pSums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		unsigned int i = 0;
+
+		for (; i + 4 <= nCount; i += 4) {
+			pSums[0] += std::fabs(pFirst[i] - pSecond[i]);
+			pSums[1] += std::fabs(pFirst[i + 1] - pSecond[i + 1]);
+			pSums[2] += std::fabs(pFirst[i + 2] - pSecond[i + 2]);
+			pSums[3] += std::fabs(pFirst[i + 3] - pSecond[i + 3]);
+		}
+
+		for (; i < nCount; i++) {
+			pSums[0] += std::fabs(pFirst[i] - pSecond[i]);
+		}
+
+		return (pSums[0] + pSums[1]) + (pSums[2] + pSums[3]);
+	}
+}
+
+fenn::Species::Species()
+	: nId(0)
+	, nAge(0)
+{
+}
+
+fenn::Speciation::Speciation()
+	: m_fExcess(SPECIES_COEFFICIENT_EXCESS)
+	, m_fDisjoint(SPECIES_COEFFICIENT_DISJOINT)
+	, m_fWeight(SPECIES_COEFFICIENT_WEIGHT)
+	, m_fThreshold(SPECIES_THRESHOLD)
+	, m_nNumSpecies(0)
+	, m_nNextId(0)
+{
+}
+
+fenn::Speciation::~Speciation()
+{
+	//nothing to do
+}
+
+void fenn::Speciation::SetCoefficients(const float fExcess, const float fDisjoint, const float fWeight)
+{
+	m_fExcess = fExcess;
+	m_fDisjoint = fDisjoint;
+	m_fWeight = fWeight;
+}
+
+void fenn::Speciation::SetThreshold(const float fThreshold)
+{
+	m_fThreshold = fThreshold;
+}
+
+float fenn::Speciation::GetThreshold() const
+{
+	return m_fThreshold;
+}
+
+float fenn::Speciation::GetDistance(const RNA &first, const RNA &second)
+{
+	if (m_veWorkspaces.empty()) {
+		m_veWorkspaces.resize(1);
+	}
+
+	return GetDistance(first, second, m_veWorkspaces[0]);
+}
+
+void fenn::Speciation::Speciate(const RNA * const *ppGenomes, const unsigned int nGenomes, comt::TaskScheduler &scheduler)
+{
+	const unsigned int nPrevious = m_nNumSpecies;
+
+	if (m_veWorkspaces.size() < scheduler.GetNumThreads()) {
+		m_veWorkspaces.resize(scheduler.GetNumThreads());
+	}
+
+	//compare every genome with the representatives of the previous species, every task compares
+	//a chunk of genomes. Every genome is only written by the thread comparing it. Only the genomes
+	//and this object are captured, such that the function fits into the small buffer of
+	//std::function and does not allocate
+	m_veGenomeSpecies.resize(nGenomes);
+
+	scheduler.Run((nGenomes + SPECIES_CHUNK_SIZE - 1) / SPECIES_CHUNK_SIZE, [this, ppGenomes](const comt::TaskScheduler::Task &task, const unsigned int iThread) {
+		const unsigned int nFirst = task.nItem * SPECIES_CHUNK_SIZE;
+		const unsigned int nLast = std::min(nFirst + SPECIES_CHUNK_SIZE, (unsigned int)m_veGenomeSpecies.size());
+
+		for (unsigned int i = nFirst; i < nLast; i++) {
+			m_veGenomeSpecies[i] = FindSpecies(*ppGenomes[i], 0, m_nNumSpecies, m_veWorkspaces[iThread]);
+		}
+	});
+
+	//the remaining genomes are compared with the species founded by the genomes preceding them,
+	//or found a new species themselves
+	for (unsigned int i = 0; i < nGenomes; i++) {
+		if (m_veGenomeSpecies[i] != SPECIES_NONE) {
+			continue;
+		}
+
+		m_veGenomeSpecies[i] = FindSpecies(*ppGenomes[i], nPrevious, m_nNumSpecies, m_veWorkspaces[0]);
+
+		if (m_veGenomeSpecies[i] == SPECIES_NONE) {
+			//new species take the place of a species which died out before, if any
+			if (m_nNumSpecies == m_veSpecies.size()) {
+				m_veSpecies.resize(m_nNumSpecies + 1);
+			}
+
+			Species &species = m_veSpecies[m_nNumSpecies];
+			species.nId = m_nNextId++;
+			species.nAge = 0;
+			species.representative.Create(*ppGenomes[i]);
+			m_veGenomeSpecies[i] = m_nNumSpecies++;
+		}
+	}
+
+	//collect the members of every species, the lists keep their capacity
+	for (unsigned int i = 0; i < m_nNumSpecies; i++) {
+		m_veSpecies[i].veMembers.clear();
+	}
+
+	for (unsigned int i = 0; i < nGenomes; i++) {
+		m_veSpecies[m_veGenomeSpecies[i]].veMembers.push_back(i);
+	}
+
+	//remove the species without members, the remaining species move down and their members are
+	//assigned the new position of their species. The removed species are swapped behind the
+	//living ones, such that their representative and member list can be reused later on
+	unsigned int nSpecies = 0;
+
+	for (unsigned int i = 0; i < m_nNumSpecies; i++) {
+		if (m_veSpecies[i].veMembers.empty()) {
+			continue;
+		}
+
+		if (nSpecies != i) {
+			std::swap(m_veSpecies[nSpecies].nId, m_veSpecies[i].nId);
+			std::swap(m_veSpecies[nSpecies].nAge, m_veSpecies[i].nAge);
+			std::swap(m_veSpecies[nSpecies].representative, m_veSpecies[i].representative);
+			m_veSpecies[nSpecies].veMembers.swap(m_veSpecies[i].veMembers);
+		}
+
+		for (const auto iMember : m_veSpecies[nSpecies].veMembers) {
+			m_veGenomeSpecies[iMember] = nSpecies;
+		}
+
+		nSpecies++;
+	}
+
+	m_nNumSpecies = nSpecies;
+
+	//every species is represented by a random member in the next population. The member is copied
+	//into the memory of the previous representative, such that the representative does not keep
+	//the memory of the population alive once the population is recycled
+	for (unsigned int i = 0; i < m_nNumSpecies; i++) {
+		Species &species = m_veSpecies[i];
+		species.representative.Create(*ppGenomes[species.veMembers[GetRandom(species.veMembers.size())]]);
+		species.nAge++;
+	}
+}
+
+void fenn::Speciation::Speciate(const std::vector<RNA> &vePopulation, comt::TaskScheduler &scheduler)
+{
+	m_veGenomePointers.resize(vePopulation.size());
+
+	for (unsigned int i = 0; i < vePopulation.size(); i++) {
+		m_veGenomePointers[i] = &vePopulation[i];
+	}
+
+	Speciate(m_veGenomePointers.data(), m_veGenomePointers.size(), scheduler);
+}
+
+void fenn::Speciation::Clear()
+{
+	//the species are kept to reuse their memory
+	m_nNumSpecies = 0;
+	m_veGenomeSpecies.clear();
+}
+
+unsigned int fenn::Speciation::GetNumSpecies() const
+{
+	return m_nNumSpecies;
+}
+
+const fenn::Species& fenn::Speciation::GetSpecies(const unsigned int nSpecies) const
+{
+	assert(nSpecies < m_nNumSpecies);
+	return m_veSpecies[nSpecies];
+}
+
+unsigned int fenn::Speciation::GetGenomeSpecies(const unsigned int iGenome) const
+{
+	assert(iGenome < m_veGenomeSpecies.size());
+	return m_veGenomeSpecies[iGenome];
+}
+
+float fenn::Speciation::GetDistance(const RNA &first, const RNA &second, Workspace &workspace) const
+{
+	assert(first.GetNumInputNeurons() == second.GetNumInputNeurons() && first.GetNumOutputNeurons() == second.GetNumOutputNeurons());
+
+	unsigned int nFirstGenes, nSecondGenes;
+	GLOBAL_INDEX_TYPE nFirstMax, nSecondMax;
+	GetConnectionGenes(first, nFirstGenes, nFirstMax);
+	GetConnectionGenes(second, nSecondGenes, nSecondMax);
+
+	unsigned int nExcess = 0;
+	unsigned int nDisjoint = 0;
+	workspace.veFirst.clear();
+	workspace.veSecond.clear();
+
+	//the input and output neurons are the same in both genomes
+	for (unsigned int i = 0; i < first.GetFirstHiddenNeuron(); i++) {
+		CompareConnections(first, first.GetNeuron(i), nFirstMax, second, second.GetNeuron(i), nSecondMax, nExcess, nDisjoint, workspace.veFirst, workspace.veSecond);
+	}
+
+	//the hidden neurons are sorted by their index, the connections of a neuron without a match
+	//do not match either
+	unsigned int iFirst = first.GetFirstHiddenNeuron();
+	unsigned int iSecond = second.GetFirstHiddenNeuron();
+
+	while (iFirst < first.GetNumNeurons() || iSecond < second.GetNumNeurons()) {
+		const NeuronAllele* const pFirst = iFirst < first.GetNumNeurons() ? &first.GetNeuron(iFirst) : NULL;
+		const NeuronAllele* const pSecond = iSecond < second.GetNumNeurons() ? &second.GetNeuron(iSecond) : NULL;
+
+		if (pFirst && pSecond && pFirst->nIndex == pSecond->nIndex) {
+			CompareConnections(first, *pFirst, nFirstMax, second, *pSecond, nSecondMax, nExcess, nDisjoint, workspace.veFirst, workspace.veSecond);
+			iFirst++;
+			iSecond++;
+		} else if (pFirst && (!pSecond || pFirst->nIndex < pSecond->nIndex)) {
+			CountUnmatched(first.GetConnections(*pFirst), pFirst->nNumConnections, nSecondMax, nExcess, nDisjoint);
+			iFirst++;
+		} else {
+			CountUnmatched(second.GetConnections(*pSecond), pSecond->nNumConnections, nFirstMax, nExcess, nDisjoint);
+			iSecond++;
+		}
+	}
+
+	//combine the terms, the gene counts are normalized by the size of the larger genome
+	const unsigned int nMatching = workspace.veFirst.size();
+	const float fGenes = (float)std::max(1u, std::max(nFirstGenes, nSecondGenes));
+	const float fWeight = nMatching > 0 ? SumAbsoluteDifferences(workspace.veFirst.data(), workspace.veSecond.data(), nMatching) / (float)nMatching : 0.0f;
+
+	return m_fExcess * (float)nExcess / fGenes + m_fDisjoint * (float)nDisjoint / fGenes + m_fWeight * fWeight;
+}
+
+unsigned int fenn::Speciation::FindSpecies(const RNA &genome, const unsigned int nFirst, const unsigned int nLast, Workspace &workspace) const
+{
+	//the first species within the threshold distance
+	for (unsigned int i = nFirst; i < nLast; i++) {
+		if (GetDistance(genome, m_veSpecies[i].representative, workspace) < m_fThreshold) {
+			return i;
+		}
+	}
+
+	return SPECIES_NONE;
+}
\ No newline at end of file
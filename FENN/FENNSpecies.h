@@ -0,0 +1,117 @@
+#ifndef FENN_SPECIES_H
+#define FENN_SPECIES_H
+
+#include "FENNConfig.h"
+#include "FENNRNA.h"
+
+#include <COMTTaskScheduler.h>
+
+#include <vector>
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Structure - Species
+	//----------------------------------------------------------------
+	// A group of genomes that are compatible with each other. The
+	// members are the indices of the genomes within the population
+	// that was last divided into species. The representative is a
+	// copy of a random member, with which the genomes of the next
+	// population are compared. It owns its memory, which is reused
+	// whenever a new representative is chosen.
+	//----------------------------------------------------------------
+	struct Species
+	{
+		Species();
+
+		//structure members
+		unsigned int				nId; //unique for every species ever created by the same speciation
+		unsigned int				nAge; //the number of populations the species has been part of
+		RNA							representative;
+		std::vector<unsigned int>	veMembers;
+	};
+
+	//----------------------------------------------------------------
+	// Class - Speciation
+	//----------------------------------------------------------------
+	// Divides populations into species using the compatibility
+	// distance of the NEAT method:
+	//		distance = cExcess * E / N + cDisjoint * D / N + cWeight * W
+	// with E and D the number of excess and disjoint connection genes,
+	// N the number of connection genes of the larger genome and W the
+	// mean absolute weight difference of the matching genes. A
+	// connection index identifies the pair of neurons it connects,
+	// hence matching connections belong to matching neurons. Both
+	// genomes keep their neurons and connections sorted by index, such
+	// that the genes are aligned in a single merge pass. The weights
+	// of the matching genes are gathered and compared in one loop
+	// afterwards, which the compiler can vectorize.
+	// Every genome joins the first species whose representative is
+	// within the threshold distance. The genomes are compared with the
+	// representatives of the previous species in parallel, only the
+	// genomes that match none of these are compared with the species
+	// founded in the current population, in order. A genome matching
+	// no species at all founds a new species. Hence the result does
+	// not depend on the number of threads. The cost is proportional
+	// to the number of genomes times the number of species, rather
+	// than the square of the number of genomes. Species without any
+	// members are removed, after which every species chooses a new
+	// representative.
+	//----------------------------------------------------------------
+	class Speciation
+	{
+	public:
+		//constructor and destructor
+		Speciation();
+		~Speciation();
+
+		//setting the coefficients of the compatibility distance and the distance within which
+		//genomes belong to the same species
+		void SetCoefficients(const float fExcess, const float fDisjoint, const float fWeight);
+		void SetThreshold(const float fThreshold);
+		float GetThreshold() const;
+
+		//computing the compatibility distance between two genomes
+		float GetDistance(const RNA &first, const RNA &second);
+
+		//dividing a population into species, the genomes are compared with the species of the
+		//previously divided population. The scheduler is used to compare the genomes in parallel
+		void Speciate(const RNA * const *ppGenomes, const unsigned int nGenomes, comt::TaskScheduler &scheduler);
+		void Speciate(const std::vector<RNA> &vePopulation, comt::TaskScheduler &scheduler);
+		void Clear();
+
+		//inspecting the species and the species of every genome of the last divided population
+		unsigned int GetNumSpecies() const;
+		const Species& GetSpecies(const unsigned int nSpecies) const;
+		unsigned int GetGenomeSpecies(const unsigned int iGenome) const;
+
+	protected:
+		//the weights of the matching genes of the genomes being compared, one per thread
+		struct Workspace
+		{
+			std::vector<WEIGHT_TYPE>	veFirst;
+			std::vector<WEIGHT_TYPE>	veSecond;
+		};
+
+		float						m_fExcess;
+		float						m_fDisjoint;
+		float						m_fWeight;
+		float						m_fThreshold;
+
+		std::vector<Species>		m_veSpecies; //the first m_nNumSpecies are alive, the others are kept to reuse their memory
+		unsigned int				m_nNumSpecies;
+		std::vector<unsigned int>	m_veGenomeSpecies;
+		unsigned int				m_nNextId;
+		std::vector<Workspace>		m_veWorkspaces;
+		std::vector<const RNA*>		m_veGenomePointers;
+
+	private:
+		Speciation(const Speciation &speciation);
+		void operator = (const Speciation &speciation);
+
+		float GetDistance(const RNA &first, const RNA &second, Workspace &workspace) const;
+		unsigned int FindSpecies(const RNA &genome, const unsigned int nFirst, const unsigned int nLast, Workspace &workspace) const;
+	};
+}
+
+#endif
\ No newline at end of file
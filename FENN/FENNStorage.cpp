@@ -0,0 +1,247 @@
+#include "FENNStorage.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+fenn::StorageWriter::StorageWriter()
+	: m_pData(NULL)
+	, m_nMax(0)
+	, m_nSize(0)
+	, m_nBits(0)
+	, m_nNumBits(0)
+	, m_bValid(true)
+{
+}
+
+fenn::StorageWriter::StorageWriter(unsigned char *pData, const unsigned int nMax)
+	: m_pData(pData)
+	, m_nMax(nMax)
+	, m_nSize(0)
+	, m_nBits(0)
+	, m_nNumBits(0)
+	, m_bValid(true)
+{
+}
+
+void fenn::StorageWriter::WriteByte(const unsigned char nValue)
+{
+	if (m_pData) {
+		if (!m_bValid || m_nSize >= m_nMax) {
+			m_bValid = false;
+			return;
+		}
+
+		m_pData[m_nSize] = nValue;
+	}
+
+	m_nSize++;
+}
+
+void fenn::StorageWriter::WriteBytes(const void *pValues, const unsigned int nCount)
+{
+	if (m_pData) {
+		if (!m_bValid || nCount > m_nMax - m_nSize) {
+			m_bValid = false;
+			return;
+		}
+
+		memcpy(m_pData + m_nSize, pValues, nCount);
+	}
+
+	m_nSize += nCount;
+}
+
+void fenn::StorageWriter::WriteUInt32(const unsigned int nValue)
+{
+	for (unsigned int i = 0; i < 4; i++) {
+		WriteByte((unsigned char)(nValue >> (8 * i)));
+	}
+}
+
+void fenn::StorageWriter::WriteUInt64(const unsigned long long nValue)
+{
+	for (unsigned int i = 0; i < 8; i++) {
+		WriteByte((unsigned char)(nValue >> (8 * i)));
+	}
+}
+
+void fenn::StorageWriter::WriteVarint(unsigned long long nValue)
+{
+	//write 7 bits at a time, the highest bit indicates whether more bytes follow
+	while (nValue >= 0x80) {
+		WriteByte((unsigned char)(nValue | 0x80));
+		nValue >>= 7;
+	}
+
+	WriteByte((unsigned char)nValue);
+}
+
+void fenn::StorageWriter::WriteSignedVarint(const long long nValue)
+{
+	//zigzag encoding maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+	WriteVarint(((unsigned long long)nValue << 1) ^ (unsigned long long)(nValue >> 63));
+}
+
+void fenn::StorageWriter::WriteFloat(const float fValue)
+{
+	unsigned int nValue;
+	memcpy(&nValue, &fValue, sizeof(nValue));
+	WriteUInt32(nValue);
+}
+
+void fenn::StorageWriter::WriteBits(const unsigned int nValue, const unsigned int nBits)
+{
+	//the bits are packed starting at the least significant bit of every byte
+	assert(nBits <= 24 && (nValue >> nBits) == 0);
+	m_nBits |= nValue << m_nNumBits;
+	m_nNumBits += nBits;
+
+	while (m_nNumBits >= 8) {
+		WriteByte((unsigned char)m_nBits);
+		m_nBits >>= 8;
+		m_nNumBits -= 8;
+	}
+}
+
+void fenn::StorageWriter::FlushBits()
+{
+	if (m_nNumBits > 0) {
+		WriteByte((unsigned char)m_nBits);
+		m_nBits = 0;
+		m_nNumBits = 0;
+	}
+}
+
+unsigned int fenn::StorageWriter::GetSize() const
+{
+	return m_nSize;
+}
+
+bool fenn::StorageWriter::IsValid() const
+{
+	return m_bValid;
+}
+
+fenn::StorageReader::StorageReader(const unsigned char *pData, const unsigned int nSize)
+	: m_pData(pData)
+	, m_nSize(nSize)
+	, m_nPosition(0)
+	, m_nBits(0)
+	, m_nNumBits(0)
+	, m_bValid(true)
+{
+}
+
+unsigned char fenn::StorageReader::ReadByte()
+{
+	if (!m_bValid || m_nPosition >= m_nSize) {
+		m_bValid = false;
+		return 0;
+	}
+
+	return m_pData[m_nPosition++];
+}
+
+void fenn::StorageReader::ReadBytes(void *pValues, const unsigned int nCount)
+{
+	if (!m_bValid || nCount > m_nSize - m_nPosition) {
+		m_bValid = false;
+		memset(pValues, 0, nCount);
+		return;
+	}
+
+	memcpy(pValues, m_pData + m_nPosition, nCount);
+	m_nPosition += nCount;
+}
+
+unsigned int fenn::StorageReader::ReadUInt32()
+{
+	unsigned int nValue = 0;
+
+	for (unsigned int i = 0; i < 4; i++) {
+		nValue |= (unsigned int)ReadByte() << (8 * i);
+	}
+
+	return nValue;
+}
+
+unsigned long long fenn::StorageReader::ReadUInt64()
+{
+	unsigned long long nValue = 0;
+
+	for (unsigned int i = 0; i < 8; i++) {
+		nValue |= (unsigned long long)ReadByte() << (8 * i);
+	}
+
+	return nValue;
+}
+
+unsigned long long fenn::StorageReader::ReadVarint()
+{
+	unsigned long long nValue = 0;
+
+	for (unsigned int nShift = 0; nShift < 64; nShift += 7) {
+		const unsigned char nByte = ReadByte();
+		nValue |= (unsigned long long)(nByte & 0x7F) << nShift;
+
+		if ((nByte & 0x80) == 0) {
+			return nValue;
+		}
+	}
+
+	//more than ten bytes, the integer is malformed
+	m_bValid = false;
+	return 0;
+}
+
+long long fenn::StorageReader::ReadSignedVarint()
+{
+	const unsigned long long nValue = ReadVarint();
+	return (long long)(nValue >> 1) ^ -(long long)(nValue & 1);
+}
+
+float fenn::StorageReader::ReadFloat()
+{
+	const unsigned int nValue = ReadUInt32();
+	float fValue;
+	memcpy(&fValue, &nValue, sizeof(fValue));
+	return fValue;
+}
+
+unsigned int fenn::StorageReader::ReadBits(const unsigned int nBits)
+{
+	assert(nBits <= 24);
+
+	while (m_nNumBits < nBits) {
+		m_nBits |= (unsigned int)ReadByte() << m_nNumBits;
+		m_nNumBits += 8;
+	}
+
+	const unsigned int nValue = m_nBits & ((1u << nBits) - 1);
+	m_nBits >>= nBits;
+	m_nNumBits -= nBits;
+	return nValue;
+}
+
+void fenn::StorageReader::AlignBits()
+{
+	//the remaining bits of the current byte are padding
+	m_nBits = 0;
+	m_nNumBits = 0;
+}
+
+unsigned int fenn::StorageReader::GetPosition() const
+{
+	return m_nPosition;
+}
+
+unsigned int fenn::StorageReader::GetRemaining() const
+{
+	return m_nSize - m_nPosition;
+}
+
+bool fenn::StorageReader::IsValid() const
+{
+	return m_bValid;
+}
\ No newline at end of file
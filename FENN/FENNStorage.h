@@ -0,0 +1,96 @@
+#ifndef FENN_STORAGE_H
+#define FENN_STORAGE_H
+
+#include "FENNConfig.h"
+
+namespace fenn
+{
+	//----------------------------------------------------------------
+	// Class - StorageWriter
+	//----------------------------------------------------------------
+	// Writes values to a byte buffer in little-endian order. Integers
+	// can be written as variable length integers (7 bits per byte),
+	// signed integers are zigzag encoded first such that small
+	// negative values remain small. Small values can be packed into
+	// bits, FlushBits() should be called after the last packed value
+	// to continue at a byte boundary. When constructed without a
+	// buffer the writer only counts the number of bytes, which is
+	// used to determine the required storage size. Writing beyond
+	// the end of the buffer marks the writer as invalid, after which
+	// nothing is written anymore.
+	//----------------------------------------------------------------
+	class StorageWriter
+	{
+	public:
+		StorageWriter();
+		StorageWriter(unsigned char *pData, const unsigned int nMax);
+
+		//writing values
+		void WriteByte(const unsigned char nValue);
+		void WriteBytes(const void *pValues, const unsigned int nCount);
+		void WriteUInt32(const unsigned int nValue);
+		void WriteUInt64(const unsigned long long nValue);
+		void WriteVarint(unsigned long long nValue);
+		void WriteSignedVarint(const long long nValue);
+		void WriteFloat(const float fValue);
+
+		//writing bit packed values
+		void WriteBits(const unsigned int nValue, const unsigned int nBits);
+		void FlushBits();
+
+		//retrieving the state of the writer
+		unsigned int GetSize() const;
+		bool IsValid() const;
+
+	protected:
+		unsigned char			*m_pData;
+		unsigned int			m_nMax;
+		unsigned int			m_nSize;
+		unsigned int			m_nBits;	//pending bits, not written yet
+		unsigned int			m_nNumBits;	//number of pending bits
+		bool					m_bValid;
+	};
+
+	//----------------------------------------------------------------
+	// Class - StorageReader
+	//----------------------------------------------------------------
+	// Reads values written by the StorageWriter. Reading beyond the
+	// end of the buffer or reading malformed variable length integers
+	// marks the reader as invalid, after which all reads return zero.
+	// The validity should therefore only be checked once all values
+	// have been read.
+	//----------------------------------------------------------------
+	class StorageReader
+	{
+	public:
+		StorageReader(const unsigned char *pData, const unsigned int nSize);
+
+		//reading values
+		unsigned char ReadByte();
+		void ReadBytes(void *pValues, const unsigned int nCount);
+		unsigned int ReadUInt32();
+		unsigned long long ReadUInt64();
+		unsigned long long ReadVarint();
+		long long ReadSignedVarint();
+		float ReadFloat();
+
+		//reading bit packed values
+		unsigned int ReadBits(const unsigned int nBits);
+		void AlignBits();
+
+		//retrieving the state of the reader
+		unsigned int GetPosition() const;
+		unsigned int GetRemaining() const;
+		bool IsValid() const;
+
+	protected:
+		const unsigned char		*m_pData;
+		unsigned int			m_nSize;
+		unsigned int			m_nPosition;
+		unsigned int			m_nBits;	//bits read but not used yet
+		unsigned int			m_nNumBits;	//number of unused bits
+		bool					m_bValid;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,12 +1,50 @@
 #include "FENNWorld.h"
-#include "FENNNeuronBase.h"
 #include "FENNRandom.h"
 
-#include <cstdlib> //for RAND_MAX
+#include <cassert>
+#include <cstddef>
+
+namespace
+{
+	//----------------------------------------------------------------
+	// Structure - IndexBlock
+	//----------------------------------------------------------------
+	// A range of indices [nNext, nEnd) reserved by a single thread.
+	// The block is only valid for the world and epoch it was reserved
+	// for, such that resetting the indices invalidates all blocks.
+	//----------------------------------------------------------------
+	struct IndexBlock
+	{
+		const fenn::World		*pWorld;
+		unsigned int			nEpoch;
+		GLOBAL_INDEX_TYPE		nNext;
+		GLOBAL_INDEX_TYPE		nEnd;
+	};
+
+	FENN_THREAD_LOCAL IndexBlock g_neuronBlock = { NULL, 0, 0, 0 };
+	FENN_THREAD_LOCAL IndexBlock g_connectionBlock = { NULL, 0, 0, 0 };
+
+	inline GLOBAL_INDEX_TYPE GetIndexFromBlock(IndexBlock &block, std::atomic<GLOBAL_INDEX_TYPE> &nCounter, const fenn::World * const pWorld,
+		const unsigned int nEpoch, const GLOBAL_INDEX_TYPE nBlockSize)
+	{
+		if (block.nNext == block.nEnd || block.nEpoch != nEpoch || block.pWorld != pWorld) {
+			//the block is used up or outdated, reserve a new one. This is the only point at which
+			//threads synchronize
+			block.pWorld = pWorld;
+			block.nEpoch = nEpoch;
+			block.nNext = nCounter.fetch_add(nBlockSize, std::memory_order_relaxed);
+			block.nEnd = block.nNext + nBlockSize;
+		}
+
+		return block.nNext++;
+	}
+}
 
 fenn::World::World()
 	: m_nNeuronIndex(0)
 	, m_nConnectionIndex(0)
+	, m_nEpoch(0)
+	, m_nBlockSize(WORLD_INDEX_BLOCK_SIZE)
 {
 }
 
@@ -17,54 +55,109 @@ fenn::World::~World()
 
 GLOBAL_INDEX_TYPE fenn::World::GetNewNeuronIndex()
 {
-	const GLOBAL_INDEX_TYPE nCur = m_nNeuronIndex;
-	m_nNeuronIndex++;
-	return nCur;
+	return GetIndexFromBlock(g_neuronBlock, m_nNeuronIndex, this, m_nEpoch.load(std::memory_order_relaxed), m_nBlockSize);
 }
 
 void fenn::World::ResetNeuronIndices()
 {
-	m_nNeuronIndex = 0;
+	m_nNeuronIndex.store(0);
+	m_nEpoch.fetch_add(1);
 }
 
 GLOBAL_INDEX_TYPE fenn::World::GetNewConnectionIndex()
 {
-	const GLOBAL_INDEX_TYPE nCur = m_nConnectionIndex;
-	m_nConnectionIndex++;
-	return nCur;
+	return GetIndexFromBlock(g_connectionBlock, m_nConnectionIndex, this, m_nEpoch.load(std::memory_order_relaxed), m_nBlockSize);
 }
 
 void fenn::World::ResetConnectionIndices()
 {
-	m_nConnectionIndex = 0;
+	m_nConnectionIndex.store(0);
+	m_nEpoch.fetch_add(1);
+}
+
+GLOBAL_INDEX_TYPE fenn::World::GetNeuronIndexCounter() const
+{
+	return m_nNeuronIndex.load();
+}
+
+void fenn::World::SetNeuronIndexCounter(const GLOBAL_INDEX_TYPE nIndex)
+{
+	//the blocks reserved before are invalidated, as these may overlap the new indices
+	m_nNeuronIndex.store(nIndex);
+	m_nEpoch.fetch_add(1);
+}
+
+GLOBAL_INDEX_TYPE fenn::World::GetConnectionIndexCounter() const
+{
+	return m_nConnectionIndex.load();
+}
+
+void fenn::World::SetConnectionIndexCounter(const GLOBAL_INDEX_TYPE nIndex)
+{
+	m_nConnectionIndex.store(nIndex);
+	m_nEpoch.fetch_add(1);
+}
+
+void fenn::World::SetIndexBlockSize(const GLOBAL_INDEX_TYPE nBlockSize)
+{
+	//a block size of one hands out all indices in increasing order
+	assert(nBlockSize > 0);
+	m_nBlockSize = nBlockSize;
+	m_nEpoch.fetch_add(1);
+}
+
+GLOBAL_INDEX_TYPE fenn::World::GetIndexBlockSize() const
+{
+	return m_nBlockSize;
 }
 
 fenn::NeuronType fenn::World::GetRandomNeuronType()
 {
-	return (NeuronType)(GetRandom() % (unsigned int)(fenn::NEURONTYPE_TOTAL));
+	return (NeuronType)(GetRandom((unsigned int)(fenn::NEURONTYPE_TOTAL)));
 }
 
 WEIGHT_TYPE fenn::World::GetRandomWeight()
 {
-	return (WEIGHT_TYPE)(GetRandom()) / RAND_MAX * WEIGHT_RANGE + WEIGHT_MIN;
+	return GetRandomContinuous() * WEIGHT_RANGE + WEIGHT_MIN;
 }
 
 WEIGHT_TYPE fenn::World::GetRandomWeightAdditive()
 {
-	return (WEIGHT_TYPE)(GetRandom()) / RAND_MAX * WEIGHT_ADDITIVE_RANGE + WEIGHT_ADDITIVE_MIN;
+	return GetRandomContinuous() * WEIGHT_ADDITIVE_RANGE + WEIGHT_ADDITIVE_MIN;
 }
 
 BIAS_TYPE fenn::World::GetRandomBias()
 {
-	return (BIAS_TYPE)(GetRandom()) / RAND_MAX * BIAS_RANGE + BIAS_MIN;
+	return GetRandomContinuous() * BIAS_RANGE + BIAS_MIN;
 }
 
 BIAS_TYPE fenn::World::GetRandomBiasAdditive()
 {
-	return (BIAS_TYPE)(GetRandom()) / RAND_MAX * BIAS_ADDITIVE_RANGE + BIAS_ADDITIVE_MIN;
+	return GetRandomContinuous() * BIAS_ADDITIVE_RANGE + BIAS_ADDITIVE_MIN;
 }
 
 SLOT_INDEX_TYPE fenn::World::GetRandomSlot()
 {
-	return (SLOT_INDEX_TYPE)(GetRandom() % SLOT_MAX);
+	//SLOT_MAX is the largest valid slot index
+	return (SLOT_INDEX_TYPE)(GetRandom((unsigned int)(SLOT_MAX) + 1));
+}
+
+void fenn::World::FillRandomWeights(WEIGHT_TYPE *pTarget, const unsigned int nCount)
+{
+	FillRandomContinuous(pTarget, nCount, WEIGHT_MIN, WEIGHT_MAX);
+}
+
+void fenn::World::FillRandomWeightsAdditive(WEIGHT_TYPE *pTarget, const unsigned int nCount)
+{
+	FillRandomContinuous(pTarget, nCount, WEIGHT_ADDITIVE_MIN, WEIGHT_ADDITIVE_MAX);
+}
+
+void fenn::World::FillRandomBiases(BIAS_TYPE *pTarget, const unsigned int nCount)
+{
+	FillRandomContinuous(pTarget, nCount, BIAS_MIN, BIAS_MAX);
+}
+
+void fenn::World::FillRandomBiasesAdditive(BIAS_TYPE *pTarget, const unsigned int nCount)
+{
+	FillRandomContinuous(pTarget, nCount, BIAS_ADDITIVE_MIN, BIAS_ADDITIVE_MAX);
 }
\ No newline at end of file
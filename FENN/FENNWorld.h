@@ -2,14 +2,27 @@
 #define FENN_WORLD_H
 
 #include "FENNConfig.h"
+#include "FENNNeuronBase.h"
 
 #include <COMTSingleton.h>
 
+#include <atomic>
+
 namespace fenn
 {
-	//forward definitions
-	enum NeuronType;
-
+	//----------------------------------------------------------------
+	// Class - World
+	//----------------------------------------------------------------
+	// The world keeps track of the global neuron and connection
+	// indices and provides the random numbers specific to neurons and
+	// connections. All functions may be called from multiple threads
+	// simultaneously. To avoid contention every thread reserves a
+	// block of indices at once and hands these out without any
+	// synchronization. As a consequence indices are unique, but not
+	// necessarily handed out in increasing order across threads.
+	// Resetting the indices or changing the block size should only be
+	// done while no other thread is retrieving indices.
+	//----------------------------------------------------------------
 	class World
 	{
 	public:
@@ -23,7 +36,20 @@ namespace fenn
 		GLOBAL_INDEX_TYPE	GetNewConnectionIndex();
 		void				ResetConnectionIndices();
 
-		//retrieving specifc random numbers (neuron mapping function, 
+		//retrieving and restoring the next index to reserve, used to continue a saved population.
+		//All indices handed out so far are below these values
+		GLOBAL_INDEX_TYPE	GetNeuronIndexCounter() const;
+		void				SetNeuronIndexCounter(const GLOBAL_INDEX_TYPE nIndex);
+
+		GLOBAL_INDEX_TYPE	GetConnectionIndexCounter() const;
+		void				SetConnectionIndexCounter(const GLOBAL_INDEX_TYPE nIndex);
+
+		//setting the number of indices a thread reserves at once
+		void				SetIndexBlockSize(const GLOBAL_INDEX_TYPE nBlockSize);
+		GLOBAL_INDEX_TYPE	GetIndexBlockSize() const;
+
+		//retrieving specifc random numbers (neuron mapping function, weights, biases and slots),
+		//these use the random number generator of the calling thread
 		NeuronType			GetRandomNeuronType();
 		WEIGHT_TYPE			GetRandomWeight();
 		WEIGHT_TYPE			GetRandomWeightAdditive();
@@ -31,12 +57,24 @@ namespace fenn
 		BIAS_TYPE			GetRandomBiasAdditive();
 		SLOT_INDEX_TYPE		GetRandomSlot();
 
+		//filling arrays with random weights and biases at once
+		void				FillRandomWeights(WEIGHT_TYPE *pTarget, const unsigned int nCount);
+		void				FillRandomWeightsAdditive(WEIGHT_TYPE *pTarget, const unsigned int nCount);
+		void				FillRandomBiases(BIAS_TYPE *pTarget, const unsigned int nCount);
+		void				FillRandomBiasesAdditive(BIAS_TYPE *pTarget, const unsigned int nCount);
+
 	protected:
-		GLOBAL_INDEX_TYPE	m_nNeuronIndex;
-		GLOBAL_INDEX_TYPE	m_nConnectionIndex;
+		std::atomic<GLOBAL_INDEX_TYPE> m_nNeuronIndex;
+		std::atomic<GLOBAL_INDEX_TYPE> m_nConnectionIndex;
+		std::atomic<unsigned int> m_nEpoch; //incremented on every reset to invalidate reserved blocks
+		GLOBAL_INDEX_TYPE	m_nBlockSize;
+
+	private:
+		World(const World &world);
+		void operator = (const World &world);
 	};
 
 	typedef comt::SingletonLazy<World> world_single;
 }
 
-#endif
\ No newline at end of file
+#endif
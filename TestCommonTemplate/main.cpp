@@ -1,36 +1,210 @@
 #include <COMTSingleton.h>
+#include <COMTSmallVector.h>
+#include <COMTTaskScheduler.h>
+#include <atomic>
 #include <iostream>
+#include <utility>
+#include <vector>
 
-class Test
+namespace
 {
-public:
-	void Set(int i) {
-		m_i = i;
+	//the number of failed checks, the tests continue after a failure such that all failures are listed
+	unsigned int g_nFailures = 0;
+
+	void Check(const bool bCondition, const char *szDescription)
+	{
+		if (!bCondition) {
+			std::cout << "FAILED: " << szDescription << std::endl;
+			g_nFailures++;
+		}
 	}
 
-	int Get() const {
-		return m_i;
+	class Test
+	{
+	public:
+		void Set(int i) {
+			m_i = i;
+		}
+
+		int Get() const {
+			return m_i;
+		}
+
+	protected:
+		int m_i;
+	};
+
+	typedef comt::SingletonLazy<Test> test;
+	typedef comt::SmallVector<int, 4> SmallInts;
+
+	void TestSingleton()
+	{
+		{
+			test::Get().Set(1050);
+		}
+
+		Check(test::Get().Get() == 1050, "singleton keeps its value");
+		test::Get().Set(5);
+		Check(test::Get().Get() == 5, "singleton is changed");
+		Check(&test::Get() == &test::Get(), "singleton is a single instance");
 	}
 
-protected:
-	int m_i;
-};
+	bool IsSequence(const SmallInts &ve, const unsigned int nSize)
+	{
+		//whether the vector holds 0, 1, ..., nSize - 1
+		if (ve.size() != nSize) {
+			return false;
+		}
+
+		for (unsigned int i = 0; i < nSize; i++) {
+			if (ve[i] != (int)i) {
+				return false;
+			}
+		}
+
+		return true;
+	}
 
-typedef comt::SingletonLazy<Test> test;
+	void TestSmallVectorGrowth()
+	{
+		SmallInts ve;
+		Check(ve.empty() && ve.IsInline() && ve.capacity() == 4, "small vector starts empty and inline");
+
+		for (int i = 0; i < 4; i++) {
+			ve.push_back(i);
+		}
+
+		Check(ve.IsInline() && IsSequence(ve, 4), "small vector stores up to N elements inline");
+
+		//growing beyond the inline storage moves the elements to allocated memory
+		ve.push_back(4);
+		Check(!ve.IsInline() && ve.capacity() >= 5 && IsSequence(ve, 5), "small vector moves to the heap when growing");
+
+		for (int i = 5; i < 100; i++) {
+			ve.push_back(i);
+		}
+
+		Check(IsSequence(ve, 100), "small vector keeps its elements while growing");
+
+		//clearing keeps the allocated memory
+		const unsigned int nCapacity = ve.capacity();
+		ve.clear();
+		Check(ve.empty() && !ve.IsInline() && ve.capacity() == nCapacity, "small vector keeps its memory when cleared");
+
+		//an element of the vector itself can be added while the vector grows
+		SmallInts veSelf;
+
+		for (int i = 0; i < 4; i++) {
+			veSelf.push_back(i);
+		}
+
+		veSelf.push_back(veSelf[0]);
+		Check(!veSelf.IsInline() && veSelf.size() == 5 && veSelf[4] == 0, "small vector adds its own element while growing");
+
+		veSelf.resize(8, 7);
+		Check(veSelf.size() == 8 && veSelf[4] == 0 && veSelf[5] == 7 && veSelf[7] == 7, "small vector is resized with a value");
+	}
+
+	void TestSmallVectorCopyMove()
+	{
+		SmallInts veInline;
+		SmallInts veHeap;
+
+		for (int i = 0; i < 3; i++) {
+			veInline.push_back(i);
+		}
+
+		for (int i = 0; i < 10; i++) {
+			veHeap.push_back(i);
+		}
+
+		//copies own their elements
+		SmallInts veCopy(veHeap);
+		veCopy[0] = 100;
+		Check(IsSequence(veHeap, 10) && veCopy.size() == 10 && veCopy[0] == 100 && veCopy[9] == 9, "small vector copies are independent");
+
+		veCopy = veInline;
+		Check(IsSequence(veCopy, 3), "small vector is assigned a shorter vector");
+
+		//moving takes over allocated memory, inline elements are copied
+		const int *pHeap = veHeap.data();
+		SmallInts veMovedHeap(std::move(veHeap));
+		Check(veMovedHeap.data() == pHeap && IsSequence(veMovedHeap, 10), "small vector move takes over allocated memory");
+		Check(veHeap.empty() && veHeap.IsInline(), "small vector is empty and inline after moving its memory");
+
+		SmallInts veMovedInline(std::move(veInline));
+		Check(veMovedInline.IsInline() && IsSequence(veMovedInline, 3), "small vector move copies inline elements");
+		Check(veInline.empty(), "small vector is empty after moving its inline elements");
+
+		veHeap.push_back(0);
+		Check(IsSequence(veHeap, 1), "small vector is usable after being moved from");
+
+		//assigning a vector to itself leaves it unchanged
+		SmallInts &veAlias = veMovedHeap;
+		veMovedHeap = veAlias;
+		Check(veMovedHeap.data() == pHeap && IsSequence(veMovedHeap, 10), "small vector is assigned to itself");
+
+		veMovedHeap = std::move(veAlias);
+		Check(veMovedHeap.data() == pHeap && IsSequence(veMovedHeap, 10), "small vector is moved into itself");
+	}
+
+	void TestTaskScheduler(const unsigned int nThreads)
+	{
+		//every item spawns a second stage, every even item a third, counting how often every stage
+		//of every item runs. The same scheduler is used for all runs
+		comt::TaskScheduler scheduler(nThreads);
+		const unsigned int pnItems[] = { 1000, 0, 3, 5000 };
+
+		for (unsigned int nRun = 0; nRun < 4; nRun++) {
+			const unsigned int nItems = pnItems[nRun];
+			std::vector<std::atomic<unsigned int> > veCounts(nItems * 3);
+			std::atomic<unsigned int> nInvalidThreads(0);
+
+			for (auto &count : veCounts) {
+				count.store(0);
+			}
+
+			scheduler.Run(nItems, [&](const comt::TaskScheduler::Task &task, const unsigned int iThread) {
+				if (iThread >= scheduler.GetNumThreads()) {
+					nInvalidThreads.fetch_add(1);
+				}
+
+				veCounts[task.nItem * 3 + task.nStage].fetch_add(1);
+
+				if (task.nStage == 0 || (task.nStage == 1 && task.nItem % 2 == 0)) {
+					const comt::TaskScheduler::Task next = { task.nItem, task.nStage + 1 };
+					scheduler.Spawn(next, iThread);
+				}
+			});
+
+			bool bOnce = true;
+			bool bSpawned = true;
+
+			for (unsigned int i = 0; i < nItems; i++) {
+				bOnce = bOnce && veCounts[i * 3].load() == 1;
+				bSpawned = bSpawned && veCounts[i * 3 + 1].load() == 1 && veCounts[i * 3 + 2].load() == (i % 2 == 0 ? 1u : 0u);
+			}
+
+			Check(nInvalidThreads.load() == 0, "task scheduler passes valid thread indices");
+			Check(bOnce, "task scheduler runs every item once");
+			Check(bSpawned, "task scheduler completes every spawned task once");
+		}
+	}
+}
 
 int main(int argc, char *pargv[])
 {
-	std::cout << "Hello world" << std::endl;
+	TestSingleton();
+	TestSmallVectorGrowth();
+	TestSmallVectorCopyMove();
+	TestTaskScheduler(1);
+	TestTaskScheduler(4);
 
-	{
-		test::Get().Set(1050);
+	if (g_nFailures > 0) {
+		std::cout << g_nFailures << " checks failed" << std::endl;
+		return 1;
 	}
 
-	std::cout << test::Get().Get() << std::endl;
-	test::Get().Set(5);
-	std::cout << test::Get().Get() << std::endl;
-	test::Get().Set(100);
-	std::cout << test::Get().Get() << std::endl;
-	std::cin.get();
+	std::cout << "All checks passed" << std::endl;
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "AllocationCounter.h"
+#include "FENNConfig.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	//the number of memory allocations made by the entire program, counted by the replaced operator new
+	std::atomic<unsigned long long> g_nAllocations(0);
+}
+
+void* operator new(std::size_t nSize)
+{
+	g_nAllocations.fetch_add(1);
+	void* const p = malloc(nSize > 0 ? nSize : 1);
+
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+void operator delete(void *p) FENN_NOEXCEPT
+{
+	free(p);
+}
+
+void operator delete(void *p, std::size_t) FENN_NOEXCEPT
+{
+	free(p);
+}
+
+unsigned long long GetNumAllocations()
+{
+	return g_nAllocations.load();
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#ifndef TESTFENN_ALLOCATIONCOUNTER_H
+#define TESTFENN_ALLOCATIONCOUNTER_H
+
+//retrieving the number of memory allocations made by the entire program so far. The global
+//operator new is replaced in AllocationCounter.cpp, in a separate translation unit such that the
+//replaced operators are not inlined into the allocators of the standard library
+unsigned long long GetNumAllocations();
+
+#endif
\ No newline at end of file
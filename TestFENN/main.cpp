@@ -0,0 +1,406 @@
+#include "FENNRNA.h"
+#include "FENNEdgeIndex.h"
+#include "FENNBrain.h"
+#include "FENNBrainKernels.h"
+#include "FENNInnovation.h"
+#include "FENNPopulation.h"
+#include "FENNRandom.h"
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	//the number of failed checks, the tests continue after a failure such that all failures are listed
+	unsigned int g_nFailures = 0;
+
+	void Check(const bool bCondition, const char *szDescription)
+	{
+		if (!bCondition) {
+			std::cout << "FAILED: " << szDescription << std::endl;
+			g_nFailures++;
+		}
+	}
+
+	fenn::RNAMutationRates GetStructuralRates()
+	{
+		//rates at which a small genome grows a few hidden neurons and connections per mutation
+		const fenn::RNAMutationRates rates = { 0.2f, 0.2f, 0.05f, 0.2f, 0.2f, 0.2f, 0.2f, 0.2f, 0.2f, fenn::MUTATIONSAMPLING_GEOMETRIC };
+		return rates;
+	}
+
+	void CreateGenome(fenn::RNA &rna, const unsigned int nMutations)
+	{
+		//a genome with hidden neurons of all types, every mutation belongs to its own generation
+		fenn::InnovationRegistry innovations;
+		rna.Create(3, 50, 2);
+
+		for (unsigned int i = 0; i < nMutations; i++) {
+			innovations.Reset();
+			rna.Mutate(GetStructuralRates(), innovations);
+		}
+	}
+
+	bool IsSameGenome(const fenn::RNA &first, const fenn::RNA &second)
+	{
+		//compares all genes and parameters of both genomes, by local index
+		if (first.GetNumNeurons() != second.GetNumNeurons() || first.GetNumInputNeurons() != second.GetNumInputNeurons() || first.GetNumOutputNeurons() != second.GetNumOutputNeurons()) {
+			return false;
+		}
+
+		for (unsigned int i = 0; i < first.GetNumNeurons(); i++) {
+			const fenn::NeuronAllele &neuronFirst = first.GetNeuron(i);
+			const fenn::NeuronAllele &neuronSecond = second.GetNeuron(i);
+
+			if (neuronFirst.nIndex != neuronSecond.nIndex || neuronFirst.eNeuronType != neuronSecond.eNeuronType || neuronFirst.nNumConnections != neuronSecond.nNumConnections ||
+				first.GetBiases()[i] != second.GetBiases()[i] || first.GetNeuronName(neuronFirst) != second.GetNeuronName(neuronSecond)) {
+				return false;
+			}
+
+			const fenn::ConnectionAllele *pFirst = first.GetConnections(neuronFirst);
+			const fenn::ConnectionAllele *pSecond = second.GetConnections(neuronSecond);
+
+			for (unsigned int j = 0; j < neuronFirst.nNumConnections; j++) {
+				if (pFirst[j].nIndex != pSecond[j].nIndex || pFirst[j].nConnectedNeuron != pSecond[j].nConnectedNeuron || pFirst[j].nConnectedSlot != pSecond[j].nConnectedSlot ||
+					first.GetWeights(neuronFirst)[j] != second.GetWeights(neuronSecond)[j]) {
+					return false;
+				}
+			}
+		}
+
+		return first.GetHash() == second.GetHash();
+	}
+
+	void TestBatchEvaluation()
+	{
+		//the batch kernels of every instruction set evaluate the same operations in the same order
+		//as the single sample evaluation, hence the results are bitwise identical
+		const unsigned int pnSamples[] = { 1, 7, 64, 203 };
+		fenn::InitializeRandom(2);
+
+		for (unsigned int nGenome = 0; nGenome < 8; nGenome++) {
+			fenn::RNA rna;
+			CreateGenome(rna, 6);
+			fenn::Brain brain(rna);
+			std::vector<VALUE_TYPE> veScratch(brain.GetBatchScratchSize());
+
+			for (const auto nSamples : pnSamples) {
+				std::vector<VALUE_TYPE> veInput(brain.GetNumInputs() * nSamples);
+				std::vector<VALUE_TYPE> veExpected(brain.GetNumOutputs() * nSamples);
+				std::vector<VALUE_TYPE> veOutput(veExpected.size());
+				std::vector<VALUE_TYPE> veSample(brain.GetNumInputs());
+				std::vector<VALUE_TYPE> veResult(brain.GetNumOutputs());
+
+				//every third sample has a zero input, to include divisions by zero
+				for (unsigned int i = 0; i < veInput.size(); i++) {
+					veInput[i] = i % 3 == 0 ? 0.0f : fenn::GetRandomContinuous() * 4.0f - 2.0f;
+				}
+
+				for (unsigned int s = 0; s < nSamples; s++) {
+					for (unsigned int i = 0; i < veSample.size(); i++) {
+						veSample[i] = veInput[i * nSamples + s];
+					}
+
+					brain.Evaluate(veSample.data(), veResult.data());
+
+					for (unsigned int i = 0; i < veResult.size(); i++) {
+						veExpected[i * nSamples + s] = veResult[i];
+					}
+				}
+
+				for (unsigned int i = 0; i < fenn::INSTRUCTIONSET_TOTAL; i++) {
+					std::fill(veOutput.begin(), veOutput.end(), 0.0f);
+					brain.EvaluateBatch(veInput.data(), veOutput.data(), nSamples, veScratch.data(), fenn::GetBrainKernels((fenn::InstructionSet)i));
+					Check(memcmp(veOutput.data(), veExpected.data(), veOutput.size() * sizeof(VALUE_TYPE)) == 0, "batch evaluation matches single sample evaluation");
+				}
+			}
+		}
+	}
+
+	void TestStorage()
+	{
+		fenn::InitializeRandom(11);
+		fenn::RNA rna;
+		CreateGenome(rna, 8);
+		rna.SetNeuronName(0, "input");
+		rna.SetNeuronName(rna.GetFirstHiddenNeuron(), "hidden");
+
+		//saving into a buffer of exactly the storage size, a smaller buffer is rejected
+		std::vector<unsigned char> veData(rna.GetStorageSize());
+		unsigned int nSize = 0;
+		Check(rna.Save(veData.data(), veData.size(), &nSize) && nSize == veData.size(), "genome is saved in its storage size");
+		Check(!rna.Save(veData.data(), veData.size() - 1, &nSize) && nSize == 0, "genome is not saved into a smaller buffer");
+
+		//loading into a genome holding other genes reproduces the saved genome
+		fenn::RNA loaded;
+		CreateGenome(loaded, 3);
+		Check(loaded.Load(veData.data(), veData.size()) && IsSameGenome(rna, loaded), "loaded genome equals the saved genome");
+
+		//the format starts with the magic FRNA followed by the version, the loaded genome is
+		//left empty when loading fails
+		std::vector<unsigned char> veCorrupt(veData);
+		veCorrupt[4]++;
+		Check(!loaded.Load(veCorrupt.data(), veCorrupt.size()) && loaded.GetNumNeurons() == 0, "genome of another version is rejected");
+
+		veCorrupt = veData;
+		veCorrupt[0] = 'X';
+		Check(!loaded.Load(veCorrupt.data(), veCorrupt.size()) && loaded.GetNumNeurons() == 0, "genome without the magic is rejected");
+
+		//every truncation of the data is rejected, as is trailing data
+		bool bTruncated = true;
+
+		for (unsigned int i = 0; i < veData.size(); i++) {
+			loaded.Create(rna);
+			bTruncated = bTruncated && !loaded.Load(veData.data(), i) && loaded.GetNumNeurons() == 0;
+		}
+
+		Check(bTruncated, "truncated genome is rejected");
+
+		veCorrupt = veData;
+		veCorrupt.push_back(0);
+		Check(!loaded.Load(veCorrupt.data(), veCorrupt.size()), "genome followed by other data is rejected");
+
+		//a genome loaded after a failure is complete again
+		Check(loaded.Load(veData.data(), veData.size()) && IsSameGenome(rna, loaded), "genome is loaded after a failed load");
+	}
+
+	void TestEdgeIndex()
+	{
+		//erasing shifts the following edges of a probe sequence back, hence after every erasure all
+		//remaining edges have to be found. The edges are checked against a map, many edges share
+		//sources and targets such that the probe sequences are long and wrap around the table
+		typedef std::pair<GLOBAL_INDEX_TYPE, GLOBAL_INDEX_TYPE> Edge;
+		fenn::InitializeRandom(22);
+		fenn::EdgeIndex edges;
+		std::map<Edge, GLOBAL_INDEX_TYPE> mapEdges;
+		bool bConsistent = true;
+
+		for (unsigned int nRound = 0; nRound < 4; nRound++) {
+			for (unsigned int i = 0; i < 3000; i++) {
+				const Edge edge(fenn::GetRandom(60), fenn::GetRandom(60));
+				const bool bNew = mapEdges.find(edge) == mapEdges.end();
+				bConsistent = bConsistent && edges.Insert(edge.first, edge.second, i) == bNew;
+
+				if (bNew) {
+					mapEdges[edge] = i;
+				}
+			}
+
+			//erase about half of the edges, verifying the entire index after every few erasures
+			for (unsigned int i = 0; i < 1500; i++) {
+				const Edge edge(fenn::GetRandom(60), fenn::GetRandom(60));
+				const bool bExists = mapEdges.erase(edge) > 0;
+				bConsistent = bConsistent && edges.Erase(edge.first, edge.second) == bExists;
+				bConsistent = bConsistent && !edges.Find(edge.first, edge.second);
+
+				if (i % 50 != 0) {
+					continue;
+				}
+
+				for (const auto &entry : mapEdges) {
+					GLOBAL_INDEX_TYPE nConnection = 0;
+					bConsistent = bConsistent && edges.Find(entry.first.first, entry.first.second, &nConnection) && nConnection == entry.second;
+				}
+			}
+
+			bConsistent = bConsistent && edges.GetNumEdges() == mapEdges.size();
+		}
+
+		Check(bConsistent, "edge index finds all remaining edges after erasing");
+
+		edges.Clear();
+		Check(edges.GetNumEdges() == 0 && !edges.Find(mapEdges.begin()->first.first, mapEdges.begin()->first.second), "edge index is empty after clearing");
+		Check(edges.Insert(1, 2, 3) && !edges.Insert(1, 2, 4) && edges.Erase(1, 2) && !edges.Erase(1, 2) && !edges.Find(1, 2), "edge is inserted and erased once");
+	}
+
+	FITNESS_TYPE GetXorFitness(const unsigned int /*iGenome*/, fenn::EvaluationContext &context)
+	{
+		//the negative squared error of the brain on the exclusive or of its inputs
+		const VALUE_TYPE pInputs[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+		FITNESS_TYPE fFitness = 0;
+
+		for (unsigned int i = 0; i < 4; i++) {
+			VALUE_TYPE fOutput = 0;
+			context.Evaluate(pInputs[i], &fOutput);
+			const VALUE_TYPE fError = fOutput - (VALUE_TYPE)((i == 1 || i == 2) ? 1 : 0);
+
+			//a division by zero may produce a value which is not a number, which counts as a large error
+			fFitness -= fError == fError ? fError * fError : 100.0f;
+		}
+
+		return fFitness;
+	}
+
+	void TestPopulation()
+	{
+		fenn::InitializeRandom(24);
+		fenn::Population population(4);
+		population.Create(64, 2, 20, 1);
+		population.SetNumElites(2);
+		population.SetMutationRates(GetStructuralRates());
+
+		const fenn::PopulationEvaluator::FUNCTION_FITNESS fitness = GetXorFitness;
+		population.Evaluate(fitness);
+
+		//the genomes of every generation are stored in one of two buffers, which are recycled
+		std::vector<const fenn::RNA*> pveGenomes[2];
+		bool bElites = true;
+		bool bRecycled = true;
+		FITNESS_TYPE fBest = population.GetFitness(population.GetChampion());
+
+		for (unsigned int nGeneration = 1; nGeneration <= 20; nGeneration++) {
+			const unsigned long long nChampion = population.GetGenome(population.GetChampion()).GetHash();
+			population.Reproduce(fitness);
+
+			//the elites are the first children, copied unchanged, hence the best fitness never drops
+			const FITNESS_TYPE fNewBest = population.GetFitness(population.GetChampion());
+			bElites = bElites && population.GetGenome(0).GetHash() == nChampion && population.GetFitness(0) == fBest && fNewBest >= fBest;
+			fBest = fNewBest;
+
+			std::vector<const fenn::RNA*> &veGenomes = pveGenomes[nGeneration % 2];
+			const std::vector<const fenn::RNA*> veCurrent(population.GetGenomes(), population.GetGenomes() + population.GetNumGenomes());
+
+			if (veGenomes.empty()) {
+				veGenomes = veCurrent;
+			}
+
+			bRecycled = bRecycled && veGenomes == veCurrent;
+		}
+
+		Check(population.GetGeneration() == 20 && population.GetNumGenomes() == 64, "population counts its generations");
+		Check(bElites, "population preserves its elites");
+		Check(bRecycled, "population alternates between two generations of genomes");
+		Check(pveGenomes[0] != pveGenomes[1], "population produces the children next to their parents");
+	}
+
+	FITNESS_TYPE GetNotANumberFitness(const unsigned int iGenome, fenn::EvaluationContext & /*context*/)
+	{
+		//every even genome has a fitness which is not a number
+		return iGenome % 2 == 0 ? std::numeric_limits<FITNESS_TYPE>::quiet_NaN() : (FITNESS_TYPE)iGenome;
+	}
+
+	void TestNotANumberFitness()
+	{
+		//a fitness which is not a number is stored as the lowest fitness, hence the genomes remain ordered
+		fenn::InitializeRandom(25);
+		fenn::Population population(4);
+		population.Create(32, 2, 20, 1);
+		population.SetMutationRates(GetStructuralRates());
+
+		const fenn::PopulationEvaluator::FUNCTION_FITNESS fitness = GetNotANumberFitness;
+		population.Evaluate(fitness);
+		bool bLowest = true;
+
+		for (unsigned int i = 0; i < population.GetNumGenomes(); i++) {
+			bLowest = bLowest && (i % 2 == 1 || population.GetFitness(i) == std::numeric_limits<FITNESS_TYPE>::lowest());
+		}
+
+		Check(bLowest, "fitness which is not a number is stored as the lowest fitness");
+		Check(population.GetChampion() == 31, "genome with a fitness which is not a number is never the champion");
+
+		bool bOrdered = true;
+
+		for (unsigned int nGeneration = 0; nGeneration < 5; nGeneration++) {
+			population.Reproduce(fitness);
+
+			for (unsigned int i = 0; i < population.GetNumGenomes(); i++) {
+				bOrdered = bOrdered && population.GetFitness(i) == population.GetFitness(i);
+			}
+		}
+
+		Check(bOrdered && population.GetChampion() == 31, "population is reproduced with fitness which is not a number");
+	}
+
+	void TestAllocations()
+	{
+		//grow a population of genomes first, such that all buffers reach their final sizes
+		fenn::InitializeRandom(19);
+		const fenn::RNAMutationRates grow = { 0.1f, 0.05f, 0.002f, 0.1f, 0.1f, 0.1f, 0.01f, 0.1f, 0.1f, fenn::MUTATIONSAMPLING_GEOMETRIC };
+		const fenn::RNAMutationRates fixed = { 0.1f, 0.0f, 0.0f, 0.1f, 0.1f, 0.1f, 0.0f, 0.1f, 0.1f, fenn::MUTATIONSAMPLING_GEOMETRIC };
+		fenn::InnovationRegistry innovations;
+		std::vector<fenn::RNA> veParents(20);
+		std::vector<fenn::RNA> veChildren(veParents.size());
+		veParents[0].Create(4, 100, 3);
+
+		for (unsigned int i = 1; i < veParents.size(); i++) {
+			veParents[i].Create(veParents[0]);
+		}
+
+		for (unsigned int nGeneration = 0; nGeneration < 30; nGeneration++) {
+			innovations.Reset();
+
+			for (unsigned int i = 0; i < veParents.size(); i++) {
+				veChildren[i].Create(&veParents[i], &veParents[(i + 1) % veParents.size()]);
+				veChildren[i].Mutate(grow, innovations);
+			}
+
+			veParents.swap(veChildren);
+		}
+
+		//once the structure no longer changes, producing a recycled child by crossover and
+		//mutation does not allocate any memory. The first generations still grow the buffers of
+		//the children to the sizes of their parents
+		unsigned long long nAllocations = 0;
+
+		for (unsigned int nGeneration = 0; nGeneration < 6; nGeneration++) {
+			const unsigned long long nBefore = GetNumAllocations();
+			innovations.Reset();
+
+			for (unsigned int i = 0; i < veParents.size(); i++) {
+				veChildren[i].Create(&veParents[i], &veParents[(i + 1) % veParents.size()]);
+				veChildren[i].Mutate(fixed, innovations);
+			}
+
+			veParents.swap(veChildren);
+			nAllocations = GetNumAllocations() - nBefore;
+		}
+
+		Check(nAllocations == 0, "reproducing recycled genomes does not allocate");
+
+		//moving genomes hands over their memory, a growing vector of genomes only allocates its own buffer
+		std::vector<fenn::RNA> veGenomes;
+		veGenomes.reserve(1);
+		veGenomes.push_back(veParents[0]);
+		const unsigned long long nBefore = GetNumAllocations();
+		veGenomes.push_back(veParents[1]);
+		veGenomes.push_back(veParents[2]);
+		Check(GetNumAllocations() - nBefore == 2, "growing a vector of genomes only allocates the vector");
+
+		const unsigned int nNeurons = veGenomes[0].GetNumNeurons();
+		const unsigned long long nHash = veGenomes[0].GetHash();
+		const unsigned long long nMoved = GetNumAllocations();
+		fenn::RNA moved(std::move(veGenomes[0]));
+		moved = std::move(veGenomes[1]);
+		moved = std::move(veGenomes[2]);
+		Check(GetNumAllocations() == nMoved, "moving genomes does not allocate");
+		Check(moved.GetHash() == veParents[2].GetHash() && veGenomes[1].GetNumNeurons() > 0, "move assignment swaps the genomes");
+
+		//a moved from genome can be created again
+		veGenomes[0].Create(veParents[0]);
+		Check(veGenomes[0].GetNumNeurons() == nNeurons && veGenomes[0].GetHash() == nHash, "moved from genome is created again");
+	}
+}
+
+int main()
+{
+	TestBatchEvaluation();
+	TestStorage();
+	TestEdgeIndex();
+	TestPopulation();
+	TestNotANumberFitness();
+	TestAllocations();
+
+	if (g_nFailures > 0) {
+		std::cout << g_nFailures << " checks failed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
\ No newline at end of file